@@ -0,0 +1,574 @@
+/* orbital_core.c
+   SDL-free simulation kernels (see orbital_core.h).
+*/
+
+#include "orbital_core.h"
+#include "orbital_simd.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* ---- kernel bodies, instantiated per ISA ---- */
+
+OC_INLINE void advance_body(double *ang, const double *omega, int first, int last, double dt) {
+    for (int i = first; i < last; ++i) {
+        double a = ang[i] + omega[i] * dt;
+        a = (a > 2.0*M_PI) ? a - 2.0*M_PI : a;
+        a = (a < 0) ? a + 2.0*M_PI : a;
+        ang[i] = a;
+    }
+}
+
+OC_INLINE void positions_body(const double *rx, const double *ry, const double *ang, int first, int last,
+                              double cx, double cy, double *x, double *y) {
+    for (int i = first; i < last; ++i) {
+        double s, c;
+        oc_sincos(ang[i], &s, &c);
+        x[i] = cx + rx[i] * c;
+        y[i] = cy + ry[i] * s;
+    }
+}
+
+/* one draw item; shared by the full and the culled (idx) draw lists so a
+   body lands on the same pixel whichever path drew it */
+OC_INLINE void draw_item(int s, double ang, double x, double y, OcDrawItem *out) {
+    out->x = (int)oc_round_near(x - s/2.0);
+    out->y = (int)oc_round_near(y - s/2.0);
+    out->s = s;
+    out->deg = (ang / (2.0*M_PI)) * 360.0 * 2.0;
+}
+
+OC_INLINE void draw_list_body(const int *size, const double *ang, int first, int last,
+                              const double *x, const double *y, OcDrawItem *out) {
+    for (int i = first; i < last; ++i) draw_item(size[i], ang[i], x[i], y[i], &out[i]);
+}
+
+OC_INLINE void draw_list_at_body(const int *size, const double *ang, const int *idx, int n,
+                                 const double *x, const double *y, OcDrawItem *out) {
+    for (int j = 0; j < n; ++j) {
+        int i = idx[j];
+        draw_item(size[i], ang[i], x[i], y[i], &out[i]);
+    }
+}
+
+OC_INLINE void compact_positions_body(const OcHot *h, int first, int last, float tau, float cx, float cy, float *x, float *y) {
+    for (int i = first; i < last; ++i) {
+        float s, c;
+        oc_sincosf(h[i].phase0 + h[i].omega * tau, &s, &c);
+        x[i] = cx + h[i].rx * c;
+        y[i] = cy + h[i].ry * s;
+    }
+}
+
+OC_INLINE void compact_draw_list_body(const OcHot *h, const int *size, int first, int last, float tau,
+                                      const float *x, const float *y, OcDrawItem *out) {
+    for (int i = first; i < last; ++i) {
+        int s = size[i];
+        float a = h[i].phase0 + h[i].omega * tau;
+        out[i].x = (int)oc_round_nearf(x[i] - s*0.5f);
+        out[i].y = (int)oc_round_nearf(y[i] - s*0.5f);
+        out[i].s = s;
+        /* SDL rotation is periodic in 360 degrees, so the angle needs no wrap */
+        out[i].deg = a * (float)(720.0 / (2.0*M_PI));
+    }
+}
+
+OC_INLINE void positions3d_body(const double *rx, const double *ry, const double *ang,
+                                const double *px, const double *py, const double *pz,
+                                const double *qx, const double *qy, const double *qz,
+                                int first, int last, double *restrict wx, double *restrict wy, double *restrict wz) {
+    /* restrict: 12 arrays are more than GCC will check for overlap at run time */
+    for (int i = first; i < last; ++i) {
+        double s, c;
+        oc_sincos(ang[i], &s, &c);
+        double u = rx[i] * c, v = ry[i] * s;
+        wx[i] = px[i] * u + qx[i] * v;
+        wy[i] = py[i] * u + qy[i] * v;
+        wz[i] = pz[i] * u + qz[i] * v;
+    }
+}
+
+/* m: camera rotation, row major */
+OC_INLINE void project_body(const double *m, double dist, double focal, const double *wx, const double *wy,
+                            const double *wz, int first, int last, double cx, double cy,
+                            double *x, double *y, float *k) {
+    const double near = 0.05 * dist;
+    const double m0 = m[0], m1 = m[1], m2 = m[2], m3 = m[3], m4 = m[4], m5 = m[5], m6 = m[6], m7 = m[7], m8 = m[8];
+    for (int i = first; i < last; ++i) {
+        double vx = m0 * wx[i] + m1 * wy[i] + m2 * wz[i];
+        double vy = m3 * wx[i] + m4 * wy[i] + m5 * wz[i];
+        double vz = m6 * wx[i] + m7 * wy[i] + m8 * wz[i];
+        double d = dist + vz;
+        /* selects on inputs only: GCC will not vectorize a select of the
+           converted result */
+        double dd = d > near ? d : near;
+        double fk = d > near ? focal : 0.0;
+        double f = focal / dd;
+        x[i] = cx + vx * f;
+        y[i] = cy + vy * f;
+        k[i] = (float)(fk / dd);
+    }
+}
+
+OC_INLINE void draw_item3d(int size, double ang, double x, double y, float k, OcDrawItem *out) {
+    double sf = oc_round_near(size * (double)k);
+    int s = (int)sf;
+    s = (s < 1 && k > 0.0f) ? 1 : s;
+    draw_item(s, ang, x, y, out);
+}
+
+OC_INLINE void draw_list3d_body(const int *size, const double *ang, int first, int last,
+                                const double *x, const double *y, const float *k, OcDrawItem *out) {
+    for (int i = first; i < last; ++i) draw_item3d(size[i], ang[i], x[i], y[i], k[i], &out[i]);
+}
+
+OC_INLINE void draw_list3d_at_body(const int *size, const double *ang, const int *idx, int n,
+                                   const double *x, const double *y, const float *k, OcDrawItem *out) {
+    for (int j = 0; j < n; ++j) {
+        int i = idx[j];
+        draw_item3d(size[i], ang[i], x[i], y[i], k[i], &out[i]);
+    }
+}
+
+/* a rotated square reaches s/sqrt(2) from its center; 0.75 s covers it */
+OC_INLINE void cull_body(const int *size, const double *x, const double *y, int first, int last,
+                         double w, double h, unsigned char *vis) {
+    for (int i = first; i < last; ++i) {
+        double r = 0.75 * size[i];
+        vis[i - first] = (x[i] + r > 0.0) & (x[i] - r < w) & (y[i] + r > 0.0) & (y[i] - r < h);
+    }
+}
+
+OC_INLINE void cull3d_body(const int *size, const double *x, const double *y, const float *k, int first, int last,
+                           double w, double h, unsigned char *vis) {
+    for (int i = first; i < last; ++i) {
+        double r = 0.75 * size[i] * (double)k[i];
+        vis[i - first] = (k[i] > 0.0f) & (x[i] + r > 0.0) & (x[i] - r < w) & (y[i] + r > 0.0) & (y[i] - r < h);
+    }
+}
+
+OC_VARIANTS(advance, (double *ang, const double *omega, int first, int last, double dt),
+            (ang, omega, first, last, dt))
+OC_VARIANTS(positions, (const double *rx, const double *ry, const double *ang, int first, int last,
+                        double cx, double cy, double *x, double *y),
+            (rx, ry, ang, first, last, cx, cy, x, y))
+OC_VARIANTS(draw_list, (const int *size, const double *ang, int first, int last,
+                        const double *x, const double *y, OcDrawItem *out),
+            (size, ang, first, last, x, y, out))
+OC_VARIANTS(draw_list_at, (const int *size, const double *ang, const int *idx, int n,
+                           const double *x, const double *y, OcDrawItem *out),
+            (size, ang, idx, n, x, y, out))
+OC_VARIANTS(compact_positions, (const OcHot *h, int first, int last, float tau, float cx, float cy, float *x, float *y),
+            (h, first, last, tau, cx, cy, x, y))
+OC_VARIANTS(compact_draw_list, (const OcHot *h, const int *size, int first, int last, float tau,
+                                const float *x, const float *y, OcDrawItem *out),
+            (h, size, first, last, tau, x, y, out))
+OC_VARIANTS(positions3d, (const double *rx, const double *ry, const double *ang,
+                          const double *px, const double *py, const double *pz,
+                          const double *qx, const double *qy, const double *qz,
+                          int first, int last, double *wx, double *wy, double *wz),
+            (rx, ry, ang, px, py, pz, qx, qy, qz, first, last, wx, wy, wz))
+OC_VARIANTS(project, (const double *m, double dist, double focal, const double *wx, const double *wy,
+                      const double *wz, int first, int last, double cx, double cy,
+                      double *x, double *y, float *k),
+            (m, dist, focal, wx, wy, wz, first, last, cx, cy, x, y, k))
+OC_VARIANTS(draw_list3d, (const int *size, const double *ang, int first, int last,
+                          const double *x, const double *y, const float *k, OcDrawItem *out),
+            (size, ang, first, last, x, y, k, out))
+OC_VARIANTS(draw_list3d_at, (const int *size, const double *ang, const int *idx, int n,
+                             const double *x, const double *y, const float *k, OcDrawItem *out),
+            (size, ang, idx, n, x, y, k, out))
+OC_VARIANTS(cull, (const int *size, const double *x, const double *y, int first, int last,
+                   double w, double h, unsigned char *vis),
+            (size, x, y, first, last, w, h, vis))
+OC_VARIANTS(cull3d, (const int *size, const double *x, const double *y, const float *k, int first, int last,
+                     double w, double h, unsigned char *vis),
+            (size, x, y, k, first, last, w, h, vis))
+
+typedef struct {
+    void (*advance)(double*, const double*, int, int, double);
+    void (*positions)(const double*, const double*, const double*, int, int, double, double, double*, double*);
+    void (*draw_list)(const int*, const double*, int, int, const double*, const double*, OcDrawItem*);
+    void (*draw_list_at)(const int*, const double*, const int*, int, const double*, const double*, OcDrawItem*);
+    void (*compact_positions)(const OcHot*, int, int, float, float, float, float*, float*);
+    void (*compact_draw_list)(const OcHot*, const int*, int, int, float, const float*, const float*, OcDrawItem*);
+    void (*positions3d)(const double*, const double*, const double*, const double*, const double*, const double*,
+                        const double*, const double*, const double*, int, int, double*, double*, double*);
+    void (*project)(const double*, double, double, const double*, const double*, const double*, int, int,
+                    double, double, double*, double*, float*);
+    void (*draw_list3d)(const int*, const double*, int, int, const double*, const double*, const float*, OcDrawItem*);
+    void (*draw_list3d_at)(const int*, const double*, const int*, int, const double*, const double*, const float*,
+                           OcDrawItem*);
+    void (*cull)(const int*, const double*, const double*, int, int, double, double, unsigned char*);
+    void (*cull3d)(const int*, const double*, const double*, const float*, int, int, double, double, unsigned char*);
+} Kernels;
+
+static Kernels g_kernels;
+static OcIsa g_isa;
+static int g_isa_ready = 0;   /* racing first calls all store the same values */
+
+static int isa_supported(OcIsa isa) {
+#if OC_DISPATCH
+    __builtin_cpu_init();
+    if (isa == OC_ISA_AVX512)
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") &&
+               __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (isa == OC_ISA_AVX2)
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+    return isa == OC_ISA_BASELINE;
+}
+
+int oc_set_isa(OcIsa isa) {
+    if (!isa_supported(isa)) return 0;
+    g_kernels.advance = OC_PICK(advance, isa);
+    g_kernels.positions = OC_PICK(positions, isa);
+    g_kernels.draw_list = OC_PICK(draw_list, isa);
+    g_kernels.draw_list_at = OC_PICK(draw_list_at, isa);
+    g_kernels.compact_positions = OC_PICK(compact_positions, isa);
+    g_kernels.compact_draw_list = OC_PICK(compact_draw_list, isa);
+    g_kernels.positions3d = OC_PICK(positions3d, isa);
+    g_kernels.project = OC_PICK(project, isa);
+    g_kernels.draw_list3d = OC_PICK(draw_list3d, isa);
+    g_kernels.draw_list3d_at = OC_PICK(draw_list3d_at, isa);
+    g_kernels.cull = OC_PICK(cull, isa);
+    g_kernels.cull3d = OC_PICK(cull3d, isa);
+    g_isa = isa;
+    g_isa_ready = 1;
+    return 1;
+}
+
+static const Kernels* kernels(void) {
+    if (!g_isa_ready) {
+        const char *env = getenv("OC_ISA");
+        OcIsa want = OC_ISA_AVX512;
+        if (env) {
+            if (strcmp(env, "baseline") == 0) want = OC_ISA_BASELINE;
+            else if (strcmp(env, "avx2") == 0) want = OC_ISA_AVX2;
+        }
+        while (!oc_set_isa(want)) want = (OcIsa)(want - 1);
+    }
+    return &g_kernels;
+}
+
+OcIsa oc_isa(void) {
+    kernels();
+    return g_isa;
+}
+
+const char* oc_isa_name(OcIsa isa) {
+    switch (isa) {
+        case OC_ISA_AVX512: return "avx512";
+        case OC_ISA_AVX2: return "avx2";
+        default: return "baseline";
+    }
+}
+
+static int grow(void **p, size_t elem, int cap) {
+    void *np = realloc(*p, elem * (size_t)cap);
+    if (!np) return 0;
+    *p = np;
+    return 1;
+}
+
+int oc_reserve(OcBodies *b, int n) {
+    if (n <= b->cap) return 1;
+    int cap = b->cap ? b->cap : 16;
+    while (cap < n) cap *= 2;
+    if (!grow((void**)&b->rx, sizeof(double), cap) ||
+        !grow((void**)&b->ry, sizeof(double), cap) ||
+        !grow((void**)&b->ang, sizeof(double), cap) ||
+        !grow((void**)&b->omega, sizeof(double), cap) ||
+        !grow((void**)&b->size, sizeof(int), cap) ||
+        !grow((void**)&b->color, sizeof(OcColor), cap) ||
+        !grow((void**)&b->parent, sizeof(int), cap)) return 0;
+    for (int i = b->cap; i < cap; ++i) b->parent[i] = -1;
+    b->cap = cap;
+    return 1;
+}
+
+void oc_free(OcBodies *b) {
+    free(b->rx); free(b->ry); free(b->ang); free(b->omega);
+    free(b->size); free(b->color); free(b->parent);
+    b->rx = b->ry = b->ang = b->omega = NULL;
+    b->size = NULL; b->color = NULL; b->parent = NULL;
+    b->n = b->cap = b->first_child = 0;
+}
+
+int oc_frame_reserve(OcFrame *f, int n) {
+    if (n <= f->cap) return 1;
+    if (!grow((void**)&f->x, sizeof(double), n) ||
+        !grow((void**)&f->y, sizeof(double), n) ||
+        !grow((void**)&f->items, sizeof(OcDrawItem), n) ||
+        !grow((void**)&f->visible, sizeof(int), n)) return 0;
+    f->cap = n;
+    return 1;
+}
+
+void oc_frame_free(OcFrame *f) {
+    free(f->x); free(f->y); free(f->items); free(f->visible);
+    f->x = f->y = NULL; f->items = NULL; f->visible = NULL;
+    f->cap = 0;
+}
+
+int oc_compact_reserve(OcCompact *c, int n) {
+    if (n <= c->cap) return 1;
+    int cap = c->cap ? c->cap : 16;
+    while (cap < n) cap *= 2;
+    if (!grow((void**)&c->hot, sizeof(OcHot), cap) ||
+        !grow((void**)&c->ang0, sizeof(double), cap) ||
+        !grow((void**)&c->omega, sizeof(double), cap) ||
+        !grow((void**)&c->size, sizeof(int), cap) ||
+        !grow((void**)&c->color, sizeof(OcColor), cap) ||
+        !grow((void**)&c->parent, sizeof(int), cap)) return 0;
+    c->cap = cap;
+    return 1;
+}
+
+void oc_compact_free(OcCompact *c) {
+    free(c->hot); free(c->ang0); free(c->omega); free(c->size); free(c->color); free(c->parent);
+    c->hot = NULL; c->ang0 = c->omega = NULL; c->size = NULL; c->color = NULL; c->parent = NULL;
+    c->n = c->cap = c->first_child = 0;
+}
+
+int oc_compact_from_bodies(OcCompact *c, const OcBodies *b, double t) {
+    if (!oc_compact_reserve(c, b->n)) return 0;
+    for (int i = 0; i < b->n; ++i) {
+        c->hot[i].rx = (float)b->rx[i];
+        c->hot[i].ry = (float)b->ry[i];
+        c->hot[i].omega = (float)b->omega[i];
+        c->omega[i] = b->omega[i];
+        c->ang0[i] = b->ang[i] - b->omega[i] * t;
+        c->size[i] = b->size[i];
+        c->color[i] = b->color[i];
+        c->parent[i] = b->parent[i];
+    }
+    c->n = b->n;
+    c->first_child = b->first_child;
+    c->t = t;
+    c->t0 = oc_epoch_start(t);
+    oc_compact_rebase(c, 0, c->n, c->t0);
+    return 1;
+}
+
+double oc_epoch_start(double t) {
+    return floor(t / OC_EPOCH_SEC) * OC_EPOCH_SEC;
+}
+
+void oc_compact_rebase(OcCompact *c, int first, int last, double t0) {
+    for (int i = first; i < last; ++i) {
+        double a = fmod(c->ang0[i] + c->omega[i] * t0, 2.0*M_PI);
+        if (a < 0) a += 2.0*M_PI;
+        c->hot[i].phase0 = (float)a;
+    }
+}
+
+void oc_compact_set_time(OcCompact *c, double t) {
+    double t0 = oc_epoch_start(t);
+    if (t0 != c->t0) {
+        oc_compact_rebase(c, 0, c->n, t0);
+        c->t0 = t0;
+    }
+    c->t = t;
+}
+
+void oc_compact_positions(const OcCompact *c, int first, int last, float tau, float cx, float cy, float *x, float *y) {
+    kernels()->compact_positions(c->hot, first, last, tau, cx, cy, x, y);
+}
+
+void oc_compact_propagate(const OcCompact *c, float cx, float cy, float *x, float *y) {
+    const int *parent = c->parent;
+    for (int i = c->first_child; i < c->n; ++i) {
+        int p = parent[i];
+        if (p < 0) continue;
+        x[i] += x[p] - cx;
+        y[i] += y[p] - cy;
+    }
+}
+
+void oc_compact_draw_list(const OcCompact *c, int first, int last, float tau, const float *x, const float *y, OcDrawItem *out) {
+    kernels()->compact_draw_list(c->hot, c->size, first, last, tau, x, y, out);
+}
+
+double oc_base_radius(int w, int h) {
+    return (w < h ? w : h) / 2.0 - 30.0;
+}
+
+void oc_init_phases(OcBodies *b) {
+    for (int i = 0; i < b->n; ++i) b->ang[i] = (double)i * (2.0*M_PI / (double)b->n);
+}
+
+void oc_advance(OcBodies *b, int first, int last, double dt) {
+    kernels()->advance(b->ang, b->omega, first, last, dt);
+}
+
+void oc_seek(OcBodies *b, int first, int last, double dt) {
+    for (int i = first; i < last; ++i) {
+        double a = fmod(b->ang[i] + b->omega[i] * dt, 2.0*M_PI);
+        b->ang[i] = a < 0 ? a + 2.0*M_PI : a;
+    }
+}
+
+void oc_positions(const OcBodies *b, int first, int last, double cx, double cy, double *x, double *y) {
+    kernels()->positions(b->rx, b->ry, b->ang, first, last, cx, cy, x, y);
+}
+
+int oc_hierarchy_update(OcBodies *b) {
+    b->first_child = b->n;
+    for (int i = 0; i < b->n; ++i) {
+        int p = b->parent[i];
+        if (p < -1 || p >= i) return i;
+        if (p >= 0 && b->first_child == b->n) b->first_child = i;
+    }
+    return -1;
+}
+
+void oc_propagate(const OcBodies *b, double cx, double cy, double *x, double *y) {
+    const int *parent = b->parent;
+    for (int i = b->first_child; i < b->n; ++i) {
+        int p = parent[i];
+        if (p < 0) continue;
+        x[i] += x[p] - cx;
+        y[i] += y[p] - cy;
+    }
+}
+
+void oc_build_draw_list(const OcBodies *b, int first, int last, const double *x, const double *y, OcDrawItem *out) {
+    kernels()->draw_list(b->size, b->ang, first, last, x, y, out);
+}
+
+#define CULL_CHUNK 1024
+
+int oc_cull(const OcBodies *b, const double *x, const double *y, const float *k, int first, int last,
+            int w, int h, int *idx) {
+    /* mask a chunk at a time (stays in L1), then a branch-free compaction */
+    unsigned char vis[CULL_CHUNK];
+    const Kernels *kn = kernels();
+    int n = 0;
+    for (int c = first; c < last; c += CULL_CHUNK) {
+        int e = last - c < CULL_CHUNK ? last : c + CULL_CHUNK;
+        if (k) kn->cull3d(b->size, x, y, k, c, e, w, h, vis);
+        else kn->cull(b->size, x, y, c, e, w, h, vis);
+        for (int i = c; i < e; ++i) {
+            idx[n] = i;
+            n += vis[i - c];
+        }
+    }
+    return n;
+}
+
+void oc_build_draw_list_at(const OcBodies *b, const int *idx, int n, const double *x, const double *y, OcDrawItem *out) {
+    kernels()->draw_list_at(b->size, b->ang, idx, n, x, y, out);
+}
+
+/* ---- 3D mode ---- */
+
+int oc_orient_reserve(OcOrient *o, int n) {
+    if (n <= o->cap) return 1;
+    int cap = o->cap ? o->cap : 16;
+    while (cap < n) cap *= 2;
+    double **arr[] = { &o->incl, &o->node, &o->argp, &o->px, &o->py, &o->pz, &o->qx, &o->qy, &o->qz };
+    for (size_t k = 0; k < sizeof(arr) / sizeof(arr[0]); ++k)
+        if (!grow((void**)arr[k], sizeof(double), cap)) return 0;
+    o->cap = cap;
+    return 1;
+}
+
+void oc_orient_free(OcOrient *o) {
+    free(o->incl); free(o->node); free(o->argp);
+    free(o->px); free(o->py); free(o->pz); free(o->qx); free(o->qy); free(o->qz);
+    memset(o, 0, sizeof(*o));
+}
+
+void oc_orient_update(OcOrient *o, int first, int last) {
+    for (int i = first; i < last; ++i) {
+        double ci = cos(o->incl[i]), si = sin(o->incl[i]);
+        double cn = cos(o->node[i]), sn = sin(o->node[i]);
+        double cw = cos(o->argp[i]), sw = sin(o->argp[i]);
+        /* first two columns of Rz(node) Rx(incl) Rz(argp) */
+        o->px[i] = cn * cw - sn * sw * ci;
+        o->py[i] = sn * cw + cn * sw * ci;
+        o->pz[i] = sw * si;
+        o->qx[i] = -cn * sw - sn * cw * ci;
+        o->qy[i] = -sn * sw + cn * cw * ci;
+        o->qz[i] = cw * si;
+    }
+}
+
+int oc_frame3d_reserve(OcFrame3D *f, int n) {
+    if (n <= f->cap) return 1;
+    if (!grow((void**)&f->wx, sizeof(double), n) ||
+        !grow((void**)&f->wy, sizeof(double), n) ||
+        !grow((void**)&f->wz, sizeof(double), n) ||
+        !grow((void**)&f->k, sizeof(float), n) ||
+        !grow((void**)&f->key, sizeof(unsigned), n) ||
+        !grow((void**)&f->order, sizeof(int), n)) return 0;
+    if (!f->bucket && !(f->bucket = malloc(sizeof(unsigned) * OC_DEPTH_BUCKETS))) return 0;
+    f->cap = n;
+    return 1;
+}
+
+void oc_frame3d_free(OcFrame3D *f) {
+    free(f->wx); free(f->wy); free(f->wz); free(f->k);
+    free(f->key); free(f->order); free(f->bucket);
+    memset(f, 0, sizeof(*f));
+}
+
+void oc_positions3d(const OcBodies *b, const OcOrient *o, int first, int last, double *wx, double *wy, double *wz) {
+    kernels()->positions3d(b->rx, b->ry, b->ang, o->px, o->py, o->pz, o->qx, o->qy, o->qz, first, last, wx, wy, wz);
+}
+
+void oc_propagate3d(const OcBodies *b, double *wx, double *wy, double *wz) {
+    const int *parent = b->parent;
+    for (int i = b->first_child; i < b->n; ++i) {
+        int p = parent[i];
+        if (p < 0) continue;
+        wx[i] += wx[p];
+        wy[i] += wy[p];
+        wz[i] += wz[p];
+    }
+}
+
+void oc_project(const OcCamera *cam, const double *wx, const double *wy, const double *wz, int first, int last,
+                double cx, double cy, double *x, double *y, float *k) {
+    /* Rx(pitch) * Ry(yaw) */
+    double cyw = cos(cam->yaw), syw = sin(cam->yaw), cp = cos(cam->pitch), sp = sin(cam->pitch);
+    const double m[9] = {
+        cyw,        0.0, syw,
+        sp * syw,   cp,  -sp * cyw,
+        -cp * syw,  sp,  cp * cyw,
+    };
+    kernels()->project(m, cam->dist, cam->focal, wx, wy, wz, first, last, cx, cy, x, y, k);
+}
+
+void oc_build_draw_list3d(const OcBodies *b, int first, int last, const double *x, const double *y, const float *k,
+                          OcDrawItem *out) {
+    kernels()->draw_list3d(b->size, b->ang, first, last, x, y, k, out);
+}
+
+void oc_build_draw_list3d_at(const OcBodies *b, const int *idx, int n, const double *x, const double *y,
+                             const float *k, OcDrawItem *out) {
+    kernels()->draw_list3d_at(b->size, b->ang, idx, n, x, y, k, out);
+}
+
+void oc_depth_order(OcFrame3D *f, const int *idx, int n) {
+    /* 16-bit keys over the frame's [kmin, kmax] and one counting pass:
+       bodies closer than 1/65536 of the depth range keep index order */
+    float lo = 0.0f, hi = 0.0f;
+    if (n > 0) lo = hi = f->k[idx ? idx[0] : 0];
+    for (int j = 1; j < n; ++j) {
+        float k = f->k[idx ? idx[j] : j];
+        lo = k < lo ? k : lo;
+        hi = k > hi ? k : hi;
+    }
+    float scale = hi > lo ? (float)(OC_DEPTH_BUCKETS - 1) / (hi - lo) : 0.0f;
+    unsigned *key = f->key, *start = f->bucket;
+    memset(start, 0, sizeof(unsigned) * OC_DEPTH_BUCKETS);
+    for (int j = 0; j < n; ++j) {
+        key[j] = (unsigned)((f->k[idx ? idx[j] : j] - lo) * scale);
+        ++start[key[j]];
+    }
+    unsigned sum = 0;
+    for (int d = 0; d < OC_DEPTH_BUCKETS; ++d) { unsigned c = start[d]; start[d] = sum; sum += c; }
+    for (int j = 0; j < n; ++j) f->order[start[key[j]]++] = idx ? idx[j] : j;
+}
@@ -0,0 +1,206 @@
+#ifndef ORBITAL_CORE_H
+#define ORBITAL_CORE_H
+
+/* orbital_core.h
+   Simulation core shared by the front-ends. No SDL here: bodies are kept as
+   structure-of-arrays so the hot loops stay linear, and each frame is turned
+   into a flat draw list that the renderer only has to walk.
+   Kernels take a [first, last) range so callers can split work across threads.
+
+   Hierarchy: a body may orbit another body (a moon) instead of the sun.
+   Bodies are stored in topological order (parent[i] < i), so world positions
+   come out of the vectorizable per-body pass (oc_positions, relative to the
+   body's own center) followed by one forward pass (oc_propagate) that adds
+   the parent's offset - no recursion and no pointer chasing.
+*/
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+typedef struct { unsigned char r, g, b, a; } OcColor;
+
+typedef struct {
+    int n, cap;
+    double *rx, *ry;   /* semi-eixos (pixels) */
+    double *ang;       /* posição angular (radians) */
+    double *omega;     /* velocidade angular (radians per second) */
+    int *size;         /* tamanho nominal do quadrado (pixels) */
+    OcColor *color;
+    int *parent;       /* body orbited, -1 = sun; always < own index */
+    int first_child;   /* first index with a parent, n when none (oc_hierarchy_update) */
+} OcBodies;
+
+/* one sprite blit: destination square and rotation */
+typedef struct {
+    int x, y, s;
+    double deg;
+} OcDrawItem;
+
+/* per-frame outputs: positions and the draw list built from them */
+typedef struct {
+    int cap;
+    double *x, *y;
+    OcDrawItem *items;
+    int *visible;      /* oc_cull */
+} OcFrame;
+
+/* Compact single-precision layout for very large N.
+   The frame loop only reads OcHot (16 bytes per body); sizes, colors and the
+   exact double parameters sit in cold arrays it never touches.
+   Precision: time stays double and is split into an epoch t0 (a multiple of
+   OC_EPOCH_SEC) plus a short local time tau = t - t0. At each epoch change
+   phase0 = ang0 + omega*t0 is recomputed in double from the cold arrays, so
+   float rounding never accumulates; per frame ang = phase0 + omega*tau in float. */
+#define OC_EPOCH_SEC 32.0
+
+typedef struct {
+    float rx, ry;      /* semi-eixos (pixels) */
+    float phase0;      /* angle at the current epoch start, [0, 2pi) */
+    float omega;       /* radians per second */
+} OcHot;
+
+typedef struct {
+    int n, cap;
+    OcHot *hot;
+    double *ang0, *omega;  /* cold: phase at t = 0 and exact angular velocity */
+    int *size;             /* cold */
+    OcColor *color;        /* cold */
+    int *parent;           /* read only from first_child on */
+    int first_child;
+    double t, t0;          /* simulated time and the epoch phase0 refers to */
+} OcCompact;
+
+/* 3D mode. Each orbit lies in its own plane, tilted by inclination, node
+   (longitude of the ascending node) and argument of periapsis, radians, the
+   usual z-x-z rotation. The ellipse (rx cos a, ry sin a) is drawn in that
+   plane: position = p * rx cos a + q * ry sin a, with p, q the plane's axes
+   (oc_orient_update). World axes are x right, y down, z away from the viewer;
+   all angles zero gives the 2D layout. A moon's plane is relative to its
+   parent's center. */
+typedef struct {
+    int n, cap;
+    double *incl, *node, *argp;
+    double *px, *py, *pz, *qx, *qy, *qz;   /* derived by oc_orient_update */
+} OcOrient;
+
+/* The camera orbits the sun: yaw around the screen's vertical axis, then
+   pitch. The eye is dist pixels from the sun; with focal == dist, an orbit
+   in the z = 0 plane keeps its 2D size at yaw = pitch = 0. */
+typedef struct {
+    double yaw, pitch, dist, focal;
+} OcCamera;
+
+/* per-frame 3D buffers: world positions and the back-to-front order */
+#define OC_DEPTH_BUCKETS 65536
+
+typedef struct {
+    int cap;
+    double *wx, *wy, *wz;
+    float *k;              /* screen pixels per world pixel, 0 = behind the eye */
+    int *order;            /* oc_depth_order */
+    unsigned *key, *bucket;
+} OcFrame3D;
+
+/* Instruction set the kernels run with (see orbital_simd.h). Picked on first
+   use from the CPU, or from the OC_ISA environment variable ("baseline",
+   "avx2", "avx512") when set. */
+typedef enum { OC_ISA_BASELINE, OC_ISA_AVX2, OC_ISA_AVX512 } OcIsa;
+
+OcIsa oc_isa(void);
+const char* oc_isa_name(OcIsa isa);
+/* force a level (benchmarks); returns 0 when this CPU or build lacks it */
+int  oc_set_isa(OcIsa isa);
+
+/* grow arrays to hold at least n bodies (contents preserved). Returns 0 on OOM. */
+int  oc_reserve(OcBodies *b, int n);
+void oc_free(OcBodies *b);
+int  oc_frame_reserve(OcFrame *f, int n);
+void oc_frame_free(OcFrame *f);
+
+int  oc_compact_reserve(OcCompact *c, int n);
+void oc_compact_free(OcCompact *c);
+
+/* take b->ang as the phases at time t */
+int  oc_compact_from_bodies(OcCompact *c, const OcBodies *b, double t);
+
+/* start of the epoch containing t */
+double oc_epoch_start(double t);
+
+/* phase0 = ang0 + omega*t0 (mod 2pi), evaluated in double */
+void oc_compact_rebase(OcCompact *c, int first, int last, double t0);
+
+/* set the simulated time, rebasing every body when the epoch changes */
+void oc_compact_set_time(OcCompact *c, double t);
+
+/* positions / draw list at local time tau = t - t0 */
+void oc_compact_positions(const OcCompact *c, int first, int last, float tau, float cx, float cy, float *x, float *y);
+void oc_compact_propagate(const OcCompact *c, float cx, float cy, float *x, float *y);
+void oc_compact_draw_list(const OcCompact *c, int first, int last, float tau, const float *x, const float *y, OcDrawItem *out);
+
+/* radius that relative semi-axes are scaled by for a w x h view */
+double oc_base_radius(int w, int h);
+
+/* spread initial phases evenly: ang[i] = i * 2pi / n */
+void oc_init_phases(OcBodies *b);
+
+/* ang += omega * dt, wrapped to [0, 2pi] */
+void oc_advance(OcBodies *b, int first, int last, double dt);
+/* same for any dt (seeks, resuming after the window was hidden): one fmod
+   per body instead of a single wrap, so a long jump lands exactly where
+   the closed form puts it */
+void oc_seek(OcBodies *b, int first, int last, double dt);
+
+/* positions around (cx, cy), each relative to its own center (the sun for roots) */
+void oc_positions(const OcBodies *b, int first, int last, double cx, double cy, double *x, double *y);
+
+/* check parent[i] in [-1, i-1] and cache first_child.
+   Returns -1 when valid, otherwise the first offending index. */
+int  oc_hierarchy_update(OcBodies *b);
+
+/* moons: add the parent's offset from (cx, cy), in one forward pass over [first_child, n) */
+void oc_propagate(const OcBodies *b, double cx, double cy, double *x, double *y);
+
+/* draw list from positions computed by oc_positions */
+void oc_build_draw_list(const OcBodies *b, int first, int last, const double *x, const double *y, OcDrawItem *out);
+
+/* View culling: writes to idx, in index order, the bodies of [first, last)
+   whose sprite can overlap the w x h view, and returns how many. k scales
+   the sprite sizes (oc_project; 0 = hidden), NULL in 2D. The test runs as a
+   vectorized pass over x/y/size; only the survivors are written out. */
+int  oc_cull(const OcBodies *b, const double *x, const double *y, const float *k, int first, int last,
+             int w, int h, int *idx);
+/* oc_build_draw_list for the n bodies listed in idx; items stay at their body index */
+void oc_build_draw_list_at(const OcBodies *b, const int *idx, int n, const double *x, const double *y, OcDrawItem *out);
+
+/* ---- 3D mode ---- */
+
+/* grow to n bodies; angles of new entries are left for the caller to set */
+int  oc_orient_reserve(OcOrient *o, int n);
+void oc_orient_free(OcOrient *o);
+/* recompute p, q of [first, last) from incl, node, argp */
+void oc_orient_update(OcOrient *o, int first, int last);
+
+int  oc_frame3d_reserve(OcFrame3D *f, int n);
+void oc_frame3d_free(OcFrame3D *f);
+
+/* world positions, each relative to its own center (the sun for roots) */
+void oc_positions3d(const OcBodies *b, const OcOrient *o, int first, int last, double *wx, double *wy, double *wz);
+/* moons: add the parent's world position, one forward pass */
+void oc_propagate3d(const OcBodies *b, double *wx, double *wy, double *wz);
+/* perspective projection around (cx, cy): screen x, y and scale k (0 when
+   the body is behind the eye) */
+void oc_project(const OcCamera *cam, const double *wx, const double *wy, const double *wz, int first, int last,
+                double cx, double cy, double *x, double *y, float *k);
+/* draw list with sprite sizes scaled by k; hidden bodies get s = 0 */
+void oc_build_draw_list3d(const OcBodies *b, int first, int last, const double *x, const double *y, const float *k,
+                          OcDrawItem *out);
+/* the same for the n bodies listed in idx (oc_cull); items stay at their body index */
+void oc_build_draw_list3d_at(const OcBodies *b, const int *idx, int n, const double *x, const double *y,
+                             const float *k, OcDrawItem *out);
+/* f->order[0..n) = bodies from farthest to nearest (ascending k): a radix
+   (counting) sort on k quantized to OC_DEPTH_BUCKETS levels, O(n) and stable.
+   Sorts the n bodies listed in idx (oc_cull), or bodies 0..n-1 when idx is NULL. */
+void oc_depth_order(OcFrame3D *f, const int *idx, int n);
+
+#endif /* ORBITAL_CORE_H */
@@ -0,0 +1,215 @@
+/* orbital_events.c
+   Closed-form event search, see orbital_events.h.
+*/
+
+#include "orbital_events.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define OE_STACK 128
+
+typedef double (*GFn)(const void *ctx, double t);
+typedef struct { double a, b, ga, gb; } Span;
+
+void oe_events_free(OeEvents *e) {
+    free(e->ev);
+    e->ev = NULL;
+    e->n = e->cap = 0;
+}
+
+int oe_events_push(OeEvents *e, OeEvent ev) {
+    if (e->n == e->cap) {
+        int cap = e->cap ? e->cap * 2 : 16;
+        OeEvent *ne = realloc(e->ev, sizeof(OeEvent) * (size_t)cap);
+        if (!ne) return 0;
+        e->ev = ne;
+        e->cap = cap;
+    }
+    e->ev[e->n++] = ev;
+    return 1;
+}
+
+void oe_position(const OcBodies *b, int i, double t, double *x, double *y) {
+    double px = 0.0, py = 0.0;
+    for (int k = i; k >= 0; k = b->parent[k]) {
+        double a = b->ang[k] + b->omega[k] * t;
+        px += b->rx[k] * cos(a);
+        py += b->ry[k] * sin(a);
+    }
+    *x = px;
+    *y = py;
+}
+
+/* bound on the speed of body i, and on how close it gets to the sun */
+static double max_speed(const OcBodies *b, int i) {
+    double v = 0.0;
+    for (int k = i; k >= 0; k = b->parent[k]) v += fabs(b->omega[k]) * fmax(b->rx[k], b->ry[k]);
+    return v;
+}
+
+static double min_radius(const OcBodies *b, int i) {
+    double r = 0.0, reach = 0.0;
+    for (int k = i; k >= 0; k = b->parent[k]) {
+        reach += fmax(b->rx[k], b->ry[k]);
+        if (b->parent[k] < 0) r += fmin(b->rx[k], b->ry[k]);
+        else r -= fmax(b->rx[k], b->ry[k]);
+    }
+    /* a moon whose path can cross the sun has no useful bound on its
+       direction; the floor keeps the scan finite (and slow) there */
+    return fmax(r, 1e-6 * reach);
+}
+
+/* g(a) and g(b) on opposite sides of 0; returns the crossing within eps */
+static double crossing(GFn g, const void *ctx, double a, double b, int a_inside, double eps) {
+    for (int it = 0; it < 64 && b - a > eps; ++it) {
+        double m = 0.5 * (a + b);
+        if ((g(ctx, m) <= 0) == a_inside) a = m; else b = m;
+    }
+    return 0.5 * (a + b);
+}
+
+static double golden(GFn g, const void *ctx, double a, double b, double eps, double *gmin) {
+    const double r = 0.6180339887498949;
+    double c = b - r * (b - a), d = a + r * (b - a);
+    double gc = g(ctx, c), gd = g(ctx, d);
+    for (int it = 0; it < 100 && b - a > eps; ++it) {
+        if (gc < gd) { b = d; d = c; gd = gc; c = b - r * (b - a); gc = g(ctx, c); }
+        else         { a = c; c = d; gc = gd; d = a + r * (b - a); gd = g(ctx, d); }
+    }
+    if (gc < gd) { *gmin = gc; return c; }
+    *gmin = gd;
+    return d;
+}
+
+/* All windows in [t0, t1] where g <= 0, g changing at most L per second.
+   Outside a window the scan jumps g/L ahead (no crossing can come sooner);
+   inside, -g/L. offset turns g back into the reported value. */
+static int windows(GFn g, const void *ctx, double L, double t0, double t1, double dt_min, double offset, OeEvents *out) {
+    double eps = dt_min * 1e-3;
+    int found = 0;
+    double t = t0, v = g(ctx, t0);
+    int inside = v <= 0, last_best = inside;
+    double start = t0, best_t = t0, best_v = v, lo = t0, hi = t0;
+    for (;;) {
+        double tn, vn;
+        if (t < t1) {
+            double step = L > 0 ? fabs(v) / L : t1 - t;
+            tn = fmin(t1, t + fmax(step, dt_min));
+            vn = g(ctx, tn);
+        } else {
+            tn = t1; vn = 1.0;   /* close a window still open at t1 */
+        }
+        if (!inside && vn <= 0) {
+            inside = 1;
+            start = crossing(g, ctx, t, tn, 0, eps);
+            best_t = tn; best_v = vn; lo = start; last_best = 1;
+        } else if (inside && vn <= 0) {
+            if (last_best) hi = tn;
+            last_best = vn < best_v;
+            if (last_best) { best_t = tn; best_v = vn; lo = t; }
+        } else if (inside) {
+            double end = t < t1 ? crossing(g, ctx, t, tn, 1, eps) : t1;
+            if (last_best) hi = end;
+            if (hi < lo) hi = lo;
+            double gm, tm = golden(g, ctx, lo, hi, eps, &gm);
+            if (gm < best_v) { best_t = tm; best_v = gm; }
+            if (!oe_events_push(out, (OeEvent){ start, end, best_t, best_v + offset })) return -1;
+            ++found;
+            inside = 0;
+        }
+        if (t >= t1) break;
+        t = tn; v = vn;
+    }
+    return found;
+}
+
+typedef struct {
+    const OcBodies *b;
+    const int *set;
+    int k;
+    double period, tol;
+} AlignCtx;
+
+/* smallest arc (mod period) holding every direction, minus tol */
+static double align_g(const void *p, double t) {
+    const AlignCtx *c = p;
+    double a[OE_MAX_SET] = { 0 };
+    for (int s = 0; s < c->k; ++s) {
+        double x, y;
+        oe_position(c->b, c->set[s], t, &x, &y);
+        double d = fmod(atan2(y, x), c->period);
+        if (d < 0) d += c->period;
+        int j = s;
+        while (j > 0 && a[j-1] > d) { a[j] = a[j-1]; --j; }
+        a[j] = d;
+    }
+    double gap = a[0] + c->period - a[c->k - 1];
+    for (int s = 1; s < c->k; ++s) gap = fmax(gap, a[s] - a[s-1]);
+    return (c->period - gap) - c->tol;
+}
+
+int oe_alignments(const OcBodies *b, const int *set, int k, double t0, double t1,
+                  double tol, int same_side, double dt_min, OeEvents *out) {
+    if (k < 2 || k > OE_MAX_SET || t1 < t0) return 0;
+    /* the arc's ends move at most as fast as the two fastest directions */
+    double l1 = 0.0, l2 = 0.0;
+    for (int s = 0; s < k; ++s) {
+        double l = max_speed(b, set[s]) / min_radius(b, set[s]);
+        if (l > l1) { l2 = l1; l1 = l; } else if (l > l2) l2 = l;
+    }
+    AlignCtx c = { b, set, k, same_side ? 2.0 * M_PI : M_PI, tol };
+    return windows(align_g, &c, l1 + l2, t0, t1, dt_min, tol, out);
+}
+
+typedef struct {
+    const OcBodies *b;
+    int i, j;
+    double dist;
+} PairCtx;
+
+static double pair_g(const void *p, double t) {
+    const PairCtx *c = p;
+    double xi, yi, xj, yj;
+    oe_position(c->b, c->i, t, &xi, &yi);
+    oe_position(c->b, c->j, t, &xj, &yj);
+    return hypot(xi - xj, yi - yj) - c->dist;
+}
+
+int oe_approaches(const OcBodies *b, int i, int j, double t0, double t1,
+                  double dist, double dt_min, OeEvents *out) {
+    if (t1 < t0) return 0;
+    PairCtx c = { b, i, j, dist };
+    return windows(pair_g, &c, max_speed(b, i) + max_speed(b, j), t0, t1, dt_min, dist, out);
+}
+
+OeEvent oe_closest(const OcBodies *b, int i, int j, double t0, double t1, double dt_min) {
+    PairCtx c = { b, i, j, 0.0 };
+    double L = max_speed(b, i) + max_speed(b, j);
+    double d0 = pair_g(&c, t0), d1 = pair_g(&c, t1);
+    double best_t = d0 <= d1 ? t0 : t1, best = fmin(d0, d1);
+    Span st[OE_STACK];
+    int sp = 0;
+    if (t1 > t0) st[sp++] = (Span){ t0, t1, d0, d1 };
+    while (sp > 0) {
+        Span s = st[--sp];
+        double a = s.a, e = s.b, da = s.ga, de = s.gb;
+        /* lowest the distance can dip between two samples L apart in slope */
+        if (0.5 * (da + de - L * (e - a)) >= best) continue;
+        if (e - a <= dt_min || sp + 2 > OE_STACK) {
+            double dm, tm = golden(pair_g, &c, a, e, dt_min * 1e-3, &dm);
+            if (dm < best) { best = dm; best_t = tm; }
+            continue;
+        }
+        double m = 0.5 * (a + e), dm = pair_g(&c, m);
+        if (dm < best) { best = dm; best_t = m; }
+        /* search the side with the lower end first: it tightens best sooner */
+        if (da < de) {
+            st[sp++] = (Span){ m, e, dm, de };
+            st[sp++] = (Span){ a, m, da, dm };
+        } else {
+            st[sp++] = (Span){ a, m, da, dm };
+            st[sp++] = (Span){ m, e, dm, de };
+        }
+    }
+    return (OeEvent){ best_t, best_t, best_t, best };
+}
@@ -0,0 +1,59 @@
+#ifndef ORBITAL_EVENTS_H
+#define ORBITAL_EVENTS_H
+
+/* orbital_events.h
+   Event search over the closed-form motion, without stepping the simulation.
+   A body's phase is ang[i] + omega[i]*t (ang holds the phases at t = 0, as
+   set by oc_init_phases / the panel: i*2pi/N), so its position relative to the
+   sun at any t is a short sum over its parent chain (oe_position).
+
+   Searches work on a function g(t) whose rate of change is bounded by L
+   (from the bodies' omega and semi-axes): where g(t) > 0 nothing can happen
+   before t + g(t)/L, so the scan jumps ahead by that much (interval pruning)
+   and only slows down near an event. Window edges are then refined by
+   bisection and the best time inside by golden-section search. dt_min is
+   the time resolution: windows shorter than it may be missed.
+
+   Units: rx/ry in any unit (results in the same unit), omega in rad/s,
+   angles in radians, times in seconds of simulation time. Each call only
+   reads b, so different queries can run on different threads.
+*/
+
+#include "orbital_core.h"
+
+typedef struct {
+    double t_start, t_end;   /* window where the condition holds, clipped to [t0, t1] */
+    double t_best;           /* best time inside it */
+    double value;            /* spread (rad) or distance at t_best */
+} OeEvent;
+
+typedef struct {
+    int n, cap;
+    OeEvent *ev;
+} OeEvents;
+
+void oe_events_free(OeEvents *e);
+int  oe_events_push(OeEvents *e, OeEvent ev);   /* 0 when out of memory */
+
+/* position of body i at time t, relative to the sun (screen axes, y down) */
+void oe_position(const OcBodies *b, int i, double t, double *x, double *y);
+
+/* Windows in [t0, t1] where the k bodies in set[] line up with the sun: the
+   directions from the sun fit in an arc of tol radians, taken modulo pi
+   (bodies on either side) or, with same_side, modulo 2pi. Appends to out and
+   returns the number found, -1 when out of memory. k must be 2..OE_MAX_SET
+   (otherwise nothing is searched and 0 is returned). */
+#define OE_MAX_SET 64
+int oe_alignments(const OcBodies *b, const int *set, int k, double t0, double t1,
+                  double tol, int same_side, double dt_min, OeEvents *out);
+
+/* Windows in [t0, t1] where bodies i and j are within dist of each other,
+   each with its closest moment. Appends to out; returns the count or -1. */
+int oe_approaches(const OcBodies *b, int i, int j, double t0, double t1,
+                  double dist, double dt_min, OeEvents *out);
+
+/* The closest approach of i and j over [t0, t1] (branch and bound on the
+   distance); t_start = t_end = t_best. */
+OeEvent oe_closest(const OcBodies *b, int i, int j, double t0, double t1, double dt_min);
+
+#endif /* ORBITAL_EVENTS_H */
@@ -0,0 +1,85 @@
+/* orbital_pick.c
+   Grid index for picking, see orbital_pick.h.
+*/
+
+#include "orbital_pick.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int grow(void **p, size_t elem, int cap) {
+    void *np = realloc(*p, elem * (size_t)cap);
+    if (!np) return 0;
+    *p = np;
+    return 1;
+}
+
+static int clampi(int v, int a, int b) { return v < a ? a : v > b ? b : v; }
+
+int op_build(OpIndex *ix, const OcDrawItem *items, const int *idx, int n, int w, int h) {
+    int gw = w > 0 ? (w + OP_CELL - 1) / OP_CELL : 1, gh = h > 0 ? (h + OP_CELL - 1) / OP_CELL : 1;
+    int nc = gw * gh;
+    if (n > ix->cap) {
+        if (!grow((void**)&ix->cell, sizeof(int), n) || !grow((void**)&ix->ids, sizeof(int), n) ||
+            !grow((void**)&ix->rank, sizeof(int), n)) return 0;
+        ix->cap = n;
+    }
+    if (nc + 1 > ix->ccap) {
+        if (!grow((void**)&ix->start, sizeof(int), nc + 1)) return 0;
+        ix->ccap = nc + 1;
+    }
+    ix->gw = gw; ix->gh = gh; ix->n = n;
+    /* count per cell into start[c + 1], prefix-sum to the cell starts,
+       scatter (each start[c] ends at the next cell's start), shift back */
+    int *start = ix->start, half = 0;
+    memset(start, 0, sizeof(int) * (size_t)(nc + 1));
+    for (int j = 0; j < n; ++j) {
+        const OcDrawItem *d = &items[idx[j]];
+        int cx = clampi((d->x + d->s / 2) / OP_CELL, 0, gw - 1);
+        int cy = clampi((d->y + d->s / 2) / OP_CELL, 0, gh - 1);
+        ix->cell[j] = cy * gw + cx;
+        ++start[ix->cell[j] + 1];
+        half = d->s / 2 > half ? d->s / 2 : half;
+    }
+    for (int c = 0; c < nc; ++c) start[c + 1] += start[c];
+    for (int j = 0; j < n; ++j) {
+        int k = start[ix->cell[j]]++;
+        ix->ids[k] = idx[j];
+        ix->rank[k] = j;
+    }
+    memmove(start + 1, start, sizeof(int) * (size_t)nc);
+    start[0] = 0;
+    ix->reach = half + 1 + OP_SLOP;
+    return 1;
+}
+
+int op_pick(const OpIndex *ix, const OcDrawItem *items, int px, int py) {
+    if (ix->n == 0 || px < 0 || py < 0 || px >= ix->gw * OP_CELL || py >= ix->gh * OP_CELL) return -1;
+    int r = ix->reach;
+    int x0 = clampi((px - r) / OP_CELL, 0, ix->gw - 1), x1 = clampi((px + r) / OP_CELL, 0, ix->gw - 1);
+    int y0 = clampi((py - r) / OP_CELL, 0, ix->gh - 1), y1 = clampi((py + r) / OP_CELL, 0, ix->gh - 1);
+    int best = -1, bestr = 0;
+    long bestd = 0;
+    for (int cy = y0; cy <= y1; ++cy) {
+        for (int cx = x0; cx <= x1; ++cx) {
+            int c = cy * ix->gw + cx;
+            for (int k = ix->start[c]; k < ix->start[c + 1]; ++k) {
+                int i = ix->ids[k];
+                const OcDrawItem *d = &items[i];
+                /* doubled coordinates keep the center of even sizes exact */
+                long dx = 2L * px + 1 - (2L * d->x + d->s), dy = 2L * py + 1 - (2L * d->y + d->s);
+                long lim = d->s + 2L * OP_SLOP;
+                if (dx < -lim || dx > lim || dy < -lim || dy > lim) continue;
+                long dd = dx * dx + dy * dy;
+                if (best < 0 || dd < bestd || (dd == bestd && ix->rank[k] > bestr)) {
+                    best = i; bestd = dd; bestr = ix->rank[k];
+                }
+            }
+        }
+    }
+    return best;
+}
+
+void op_free(OpIndex *ix) {
+    free(ix->cell); free(ix->start); free(ix->ids); free(ix->rank);
+    memset(ix, 0, sizeof(*ix));
+}
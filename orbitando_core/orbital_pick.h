@@ -0,0 +1,37 @@
+#ifndef ORBITAL_PICK_H
+#define ORBITAL_PICK_H
+
+/* orbital_pick.h
+   Which body is under the pointer. A uniform grid over the view (cells of
+   OP_CELL pixels) holds the bodies that survived culling (oc_cull), bucketed
+   by the cell of their sprite's center with a counting sort: refreshing it
+   from the frame's draw items is one O(visible) pass and allocates nothing
+   once warm. A query only visits the cells within the largest sprite's
+   reach of the point, so it does not depend on how many bodies there are,
+   only on how many share those few cells.
+*/
+
+#include "orbital_core.h"
+
+#define OP_CELL 32
+#define OP_SLOP 3   /* pixels around a sprite that still count as a hit */
+
+typedef struct {
+    int n, cap;        /* bodies indexed */
+    int gw, gh, ccap;  /* cells across and down, cells allocated */
+    int reach;         /* largest sprite half-size + OP_SLOP */
+    int *cell;         /* cell of each listed body */
+    int *start;        /* gw*gh + 1 offsets into ids */
+    int *ids;          /* body indices grouped by cell */
+    int *rank;         /* position of each of ids in the draw order */
+} OpIndex;
+
+/* index the n bodies listed in idx by their draw items, on a w x h view.
+   idx is the draw order (back to front in 3D). Returns 0 when out of memory. */
+int  op_build(OpIndex *ix, const OcDrawItem *items, const int *idx, int n, int w, int h);
+/* the body whose sprite covers (px, py), the nearest center when several
+   do (on a tie, the one later in the draw order: it is on top); -1 when none */
+int  op_pick(const OpIndex *ix, const OcDrawItem *items, int px, int py);
+void op_free(OpIndex *ix);
+
+#endif /* ORBITAL_PICK_H */
@@ -0,0 +1,631 @@
+/* orbital_render.c
+   Per-body sprite and orbit-background caches (see orbital_render.h).
+*/
+
+#include "orbital_render.h"
+#include "orbital_simd.h"
+#include "orbital_trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+static const SDL_Color orbit_col = {64,200,220,255};
+
+static int grow(void **p, size_t elem, int cap) {
+    void *np = realloc(*p, elem * (size_t)cap);
+    if (!np) return 0;
+    *p = np;
+    return 1;
+}
+
+SDL_Texture* or_make_square_texture(SDL_Renderer *rnd, int size, OcColor col) {
+    SDL_Texture *tex = SDL_CreateTexture(rnd, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, size, size);
+    if (!tex) return NULL;
+    SDL_Texture *old = SDL_GetRenderTarget(rnd);
+    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderTarget(rnd, tex);
+    SDL_SetRenderDrawBlendMode(rnd, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(rnd, col.r, col.g, col.b, col.a);
+    SDL_Rect r = {0,0,size,size};
+    SDL_RenderFillRect(rnd, &r);
+    SDL_SetRenderDrawColor(rnd, (Uint8)fmax(0,col.r-30), (Uint8)fmax(0,col.g-30), (Uint8)fmax(0,col.b-30), col.a);
+    SDL_RenderDrawRect(rnd, &r);
+    SDL_SetRenderTarget(rnd, old);
+    return tex;
+}
+
+static int same_color(OcColor a, OcColor b) {
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+int or_sprites_sync(OrSprites *sp, SDL_Renderer *rnd, const OcBodies *b) {
+    if (b->n > sp->cap) {
+        int cap = b->cap;
+        if (!grow((void**)&sp->tex, sizeof(SDL_Texture*), cap) ||
+            !grow((void**)&sp->key_size, sizeof(int), cap) ||
+            !grow((void**)&sp->key_color, sizeof(OcColor), cap)) return 0;
+        for (int i = sp->cap; i < cap; ++i) sp->tex[i] = NULL;
+        sp->cap = cap;
+    }
+    int rebuilt = 0;
+    OTR_BEGIN("sprite sync");
+    for (int i = 0; i < b->n; ++i) {
+        if (sp->tex[i] && sp->key_size[i] == b->size[i] && same_color(sp->key_color[i], b->color[i])) continue;
+        if (sp->tex[i]) SDL_DestroyTexture(sp->tex[i]);
+        sp->tex[i] = or_make_square_texture(rnd, b->size[i], b->color[i]);
+        sp->key_size[i] = b->size[i];
+        sp->key_color[i] = b->color[i];
+        ++rebuilt;
+    }
+    for (int i = b->n; i < sp->n; ++i) {
+        if (sp->tex[i]) { SDL_DestroyTexture(sp->tex[i]); sp->tex[i] = NULL; }
+    }
+    sp->n = b->n;
+    OTR_END();
+    return rebuilt;
+}
+
+void or_sprites_free(OrSprites *sp) {
+    for (int i = 0; i < sp->n; ++i) if (sp->tex[i]) SDL_DestroyTexture(sp->tex[i]);
+    free(sp->tex); free(sp->key_size); free(sp->key_color);
+    sp->tex = NULL; sp->key_size = NULL; sp->key_color = NULL;
+    sp->n = sp->cap = 0;
+}
+
+#define ROT_TEX_W 4096
+
+static int rot_frames(const OrRotCache *rc) { return rc->angles / 4; }
+
+static size_t rot_bytes(const OrRotCache *rc, int s, int *box, int *cols, int *w, int *h) {
+    int bx = (int)ceil(s * 1.41421356237309505) + 2, frames = rot_frames(rc);   /* diagonal */
+    int c = ROT_TEX_W / bx;
+    if (c > frames) c = frames;
+    int rows = (frames + c - 1) / c;
+    *box = bx; *cols = c; *w = c * bx; *h = rows * bx;
+    return (size_t)*w * (size_t)*h * 4;
+}
+
+static void rot_drop(OrRotCache *rc, int s) {
+    int bx, cols, w, h;
+    SDL_DestroyTexture(rc->tex[s]);
+    rc->tex[s] = NULL;
+    rc->bytes -= rot_bytes(rc, s, &bx, &cols, &w, &h);
+    --rc->sizes;
+}
+
+static int rot_build(OrRotCache *rc, SDL_Renderer *rnd, int s, size_t need) {
+    int bx, cols, w, h;
+    rot_bytes(rc, s, &bx, &cols, &w, &h);
+    /* same white square (and ~30 darker border) as the atlas */
+    SDL_Texture *sq = or_make_square_texture(rnd, s, (OcColor){255, 255, 255, 255});
+    SDL_Texture *tex = sq ? SDL_CreateTexture(rnd, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h) : NULL;
+    if (!tex) {
+        if (sq) SDL_DestroyTexture(sq);
+        return 0;
+    }
+    SDL_Texture *old = SDL_GetRenderTarget(rnd);
+    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    SDL_SetTextureBlendMode(sq, SDL_BLENDMODE_NONE);
+    SDL_SetRenderTarget(rnd, tex);
+    SDL_SetRenderDrawBlendMode(rnd, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(rnd, 0, 0, 0, 0);
+    SDL_RenderClear(rnd);
+    int o = bx/2 - s/2;
+    SDL_Point center = { s/2, s/2 };
+    for (int f = 0; f < rot_frames(rc); ++f) {
+        SDL_Rect dst = { (f % cols) * bx + o, (f / cols) * bx + o, s, s };
+        SDL_RenderCopyEx(rnd, sq, NULL, &dst, f * 360.0 / rc->angles, &center, SDL_FLIP_NONE);
+    }
+    SDL_SetRenderTarget(rnd, old);
+    SDL_DestroyTexture(sq);
+    rc->tex[s] = tex;
+    rc->box[s] = bx;
+    rc->cols[s] = cols;
+    rc->bytes += need;
+    ++rc->sizes;
+    return 1;
+}
+
+int or_rotcache_sync(OrRotCache *rc, SDL_Renderer *rnd, const OcBodies *b) {
+    unsigned char used[OR_ATLAS_MAX_SIZE + 1] = { 0 };
+    for (int i = 0; i < b->n; ++i)
+        if (b->size[i] >= 1 && b->size[i] <= OR_ATLAS_MAX_SIZE) used[b->size[i]] = 1;
+    OTR_BEGIN("rotcache sync");
+    for (int s = 1; s <= OR_ATLAS_MAX_SIZE; ++s)
+        if (rc->tex[s] && !used[s]) rot_drop(rc, s);
+    /* smallest first: they are the cheapest and, with many bodies, the most
+       common; once one does not fit no larger one will */
+    int built = 0;
+    for (int s = 1; s <= OR_ATLAS_MAX_SIZE; ++s) {
+        if (!used[s] || rc->tex[s]) continue;
+        int bx, cols, w, h;
+        size_t need = rot_bytes(rc, s, &bx, &cols, &w, &h);
+        if (rc->bytes + need > rc->budget) break;
+        if (!rot_build(rc, rnd, s, need)) break;
+        ++built;
+    }
+    OTR_END();
+    return built;
+}
+
+void or_rotcache_free(OrRotCache *rc) {
+    for (int s = 1; s <= OR_ATLAS_MAX_SIZE; ++s)
+        if (rc->tex[s]) rot_drop(rc, s);
+}
+
+OC_INLINE void tessellate_body(int cx, int cy, int a, int b, int segments, SDL_Point *out) {
+    double step = 2.0 * M_PI / segments;
+    for (int i = 0; i <= segments; ++i) {
+        double s, c;
+        oc_sincos(step * i, &s, &c);
+        out[i].x = cx + (int)oc_round_near(a * c);
+        out[i].y = cy + (int)oc_round_near(b * s);
+    }
+}
+
+OC_VARIANTS(tessellate, (int cx, int cy, int a, int b, int segments, SDL_Point *out),
+            (cx, cy, a, b, segments, out))
+
+void or_tessellate_ellipse(int cx, int cy, int a, int b, int segments, SDL_Point *out) {
+    OC_PICK(tessellate, oc_isa())(cx, cy, a, b, segments, out);
+}
+
+/* can the ellipse's outline cross the view? Not when its box misses the
+   view, nor when all four corners are inside it (view within the orbit) */
+static int orbit_in_view(const OrBackground *bg, int cx, int cy, int a, int b) {
+    if (cx + a < -1 || cx - a > bg->w || cy + b < -1 || cy - b > bg->h) return 0;
+    if (a < 2 || b < 2) return 1;
+    double ia = 1.0 / (a - 1), ib = 1.0 / (b - 1);
+    for (int k = 0; k < 4; ++k) {
+        double u = ((k & 1) ? bg->w : 0) - cx, v = ((k & 2) ? bg->h : 0) - cy;
+        if ((u * ia) * (u * ia) + (v * ib) * (v * ib) >= 1.0) return 1;
+    }
+    return 0;
+}
+
+/* Orbits far larger than the view (deep zoom). A chord spanning dt of the
+   parameter stays within r*dt^2/8 of the arc (r = larger semi-axis), so
+   arcs are cut into DEEP_COARSE pieces, pieces whose padded chord box
+   misses the view are dropped and the rest are tessellated at a step that
+   keeps the error under half a pixel. */
+#define DEEP_COARSE 64
+
+static void draw_orbit_deep(SDL_Renderer *rnd, OrBackground *bg, int cx, int cy, int a, int b) {
+    double r = a > b ? a : b;
+    double fine = sqrt(4.0 / r), step = 2.0 * M_PI / DEEP_COARSE;
+    int coarse = DEEP_COARSE, m = (int)ceil(step / fine);
+    while (m > bg->segments) { coarse *= 2; step *= 0.5; m = (int)ceil(step / fine); }
+    double pad = r * step * step / 8.0 + 1.0;
+    double x0 = cx + a, y0 = cy;
+    for (int c = 0; c < coarse; ++c) {
+        double t1 = step * (c + 1);
+        double x1 = cx + a * cos(t1), y1 = cy + b * sin(t1);
+        int hit = fmax(x0, x1) + pad >= 0 && fmin(x0, x1) - pad <= bg->w &&
+                  fmax(y0, y1) + pad >= 0 && fmin(y0, y1) - pad <= bg->h;
+        if (hit) {
+            for (int s = 0; s <= m; ++s) {
+                double t = step * c + step * s / m;
+                bg->scratch[s] = (SDL_Point){ (int)lround(cx + a * cos(t)), (int)lround(cy + b * sin(t)) };
+            }
+            SDL_RenderDrawLines(rnd, bg->scratch, m + 1);
+        }
+        x0 = x1; y0 = y1;
+    }
+}
+
+void or_background_draw(SDL_Renderer *rnd, const OrBackground *bg) {
+    int dx = bg->ox - bg->key_ox, dy = bg->oy - bg->key_oy;
+    if (!bg->tex || dx || dy) {
+        SDL_SetRenderDrawColor(rnd, 0,0,0,255);
+        SDL_RenderClear(rnd);
+    }
+    if (!bg->tex) return;
+    SDL_Rect dst = { dx, dy, bg->w, bg->h };
+    SDL_RenderCopy(rnd, bg->tex, NULL, &dst);
+}
+
+/* returns 0 when the orbit was culled */
+static int draw_orbit(SDL_Renderer *rnd, OrBackground *bg, int a, int b, SDL_Color col) {
+    int cx = bg->w/2 + bg->key_ox, cy = bg->h/2 + bg->key_oy;
+    if (!orbit_in_view(bg, cx, cy, a, b)) return 0;
+    SDL_SetRenderDrawColor(rnd, col.r, col.g, col.b, col.a);
+    /* whole ellipse at bg->segments while its chords stay within a pixel */
+    double step = 2.0 * M_PI / bg->segments;
+    if ((a > b ? a : b) * step * step > 8.0) {
+        draw_orbit_deep(rnd, bg, cx, cy, a, b);
+        return 1;
+    }
+    or_tessellate_ellipse(cx, cy, a, b, bg->segments, bg->scratch);
+    SDL_RenderDrawLines(rnd, bg->scratch, bg->segments + 1);
+    return 1;
+}
+
+static void draw_sun(SDL_Renderer *rnd, const OrBackground *bg) {
+    int cx = bg->w/2 + bg->key_ox, cy = bg->h/2 + bg->key_oy;
+    SDL_SetRenderDrawColor(rnd, 255,215,0,255);
+    SDL_Rect sun = {cx-8, cy-8, 16, 16};
+    SDL_RenderFillRect(rnd, &sun);
+}
+
+/* radial band [lo, hi] an orbit's pixels can touch */
+typedef struct { int lo, hi; } Band;
+
+static int cmp_band(const void *pa, const void *pb) {
+    const Band *a = pa, *b = pb;
+    return (a->lo > b->lo) - (a->lo < b->lo);
+}
+
+static Band orbit_band(int a, int b) {
+    Band r = { (a < b ? a : b) - 1, (a > b ? a : b) + 1 };
+    return r;
+}
+
+/* does [lo, hi] overlap any of the sorted, merged bands? */
+static int band_hit(const Band *bands, int nb, Band q) {
+    int lo = 0, hi = nb - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (bands[mid].hi < q.lo) lo = mid + 1;
+        else if (bands[mid].lo > q.hi) hi = mid - 1;
+        else return 1;
+    }
+    return 0;
+}
+
+/* rounded semi-axes of body i's orbit; moons get -1 because their orbit moves
+   with the parent and is not part of the static background (trails show it) */
+static int orbit_key(const OcBodies *b, int i, int *kb) {
+    if (b->parent[i] >= 0) { *kb = -1; return -1; }
+    *kb = (int)round(b->ry[i]);
+    return (int)round(b->rx[i]);
+}
+
+static int redraw_all(OrBackground *bg, SDL_Renderer *rnd, const OcBodies *b) {
+    bg->key_ox = bg->ox; bg->key_oy = bg->oy;
+    SDL_SetRenderDrawColor(rnd, 0,0,0,255);
+    SDL_RenderClear(rnd);
+    int drawn = 0;
+    for (int i = 0; i < b->n; ++i) {
+        bg->key_a[i] = orbit_key(b, i, &bg->key_b[i]);
+        if (bg->key_a[i] >= 0) drawn += draw_orbit(rnd, bg, bg->key_a[i], bg->key_b[i], orbit_col);
+    }
+    draw_sun(rnd, bg);
+    return drawn;
+}
+
+int or_background_sync(OrBackground *bg, SDL_Renderer *rnd, const OcBodies *b, int w, int h) {
+    /* while panning, orbits (and changed ones) stay at the offset tex was drawn with */
+    int full = bg->view3d || (!bg->hold && (bg->ox != bg->key_ox || bg->oy != bg->key_oy));
+    bg->view3d = 0;
+    if (!bg->tex || bg->w != w || bg->h != h) {
+        if (bg->tex) SDL_DestroyTexture(bg->tex);
+        bg->tex = SDL_CreateTexture(rnd, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
+        if (!bg->tex) return 0;
+        bg->w = w; bg->h = h;
+        full = 1;
+    }
+    if (!bg->scratch && !(bg->scratch = malloc(sizeof(SDL_Point) * (bg->segments + 1)))) return 0;
+    if (b->cap > bg->cap) {
+        if (!grow((void**)&bg->key_a, sizeof(int), b->cap) ||
+            !grow((void**)&bg->key_b, sizeof(int), b->cap)) return 0;
+        bg->cap = b->cap;
+    }
+
+    /* diff against what is drawn; bodies beyond either count count as changed */
+    int oldN = bg->n, newN = b->n;
+    int span = oldN > newN ? oldN : newN;
+    int changed = 0;
+    for (int i = 0; i < span && !full; ++i) {
+        int kb = 0, ka = i < newN ? orbit_key(b, i, &kb) : 0;
+        if (i >= oldN || i >= newN || bg->key_a[i] != ka || bg->key_b[i] != kb) ++changed;
+    }
+    if (!full && changed == 0) return 0;
+
+    OTR_BEGIN("orbit redraw");
+    SDL_Texture *old = SDL_GetRenderTarget(rnd);
+    SDL_SetRenderTarget(rnd, bg->tex);
+    SDL_SetRenderDrawBlendMode(rnd, SDL_BLENDMODE_NONE);
+    int drawn;
+    Band *bands = NULL;
+    if (full || changed * 2 > newN || !(bands = malloc(sizeof(Band) * changed))) {
+        drawn = redraw_all(bg, rnd, b);
+    } else {
+        /* erase the old orbits of changed bodies */
+        const SDL_Color black = {0,0,0,255};
+        int nb = 0;
+        for (int i = 0; i < oldN; ++i) {
+            int kb = 0, ka = i < newN ? orbit_key(b, i, &kb) : 0;
+            if (i < newN && bg->key_a[i] == ka && bg->key_b[i] == kb) continue;
+            if (bg->key_a[i] < 0) continue;
+            draw_orbit(rnd, bg, bg->key_a[i], bg->key_b[i], black);
+            bands[nb++] = orbit_band(bg->key_a[i], bg->key_b[i]);
+        }
+        qsort(bands, nb, sizeof(Band), cmp_band);
+        int merged = 0;
+        for (int k = 0; k < nb; ++k) {
+            if (merged && bands[k].lo <= bands[merged-1].hi) {
+                if (bands[k].hi > bands[merged-1].hi) bands[merged-1].hi = bands[k].hi;
+            } else bands[merged++] = bands[k];
+        }
+        /* draw changed orbits, and restore unchanged ones the erase went across */
+        drawn = 0;
+        for (int i = 0; i < newN; ++i) {
+            int bb, a = orbit_key(b, i, &bb);
+            int same = i < oldN && bg->key_a[i] == a && bg->key_b[i] == bb;
+            bg->key_a[i] = a; bg->key_b[i] = bb;
+            if (a < 0 || (same && !band_hit(bands, merged, orbit_band(a, bb)))) continue;
+            drawn += draw_orbit(rnd, bg, a, bb, orbit_col);
+        }
+        draw_sun(rnd, bg);
+        free(bands);
+    }
+    SDL_SetRenderTarget(rnd, old);
+    bg->n = newN;
+    OTR_END();
+    return drawn;
+}
+
+void or_background_free(OrBackground *bg) {
+    if (bg->tex) SDL_DestroyTexture(bg->tex);
+    free(bg->key_a); free(bg->key_b); free(bg->scratch);
+    bg->tex = NULL; bg->key_a = bg->key_b = NULL; bg->scratch = NULL;
+    bg->n = bg->cap = 0;
+}
+
+/* segments for an orbit about r pixels across on screen: ~6 px each */
+static int orbit_segments(double r, int max_seg) {
+    int n = (int)(2.0 * M_PI * r / 6.0);
+    return n < 24 ? 24 : n > max_seg ? max_seg : n;
+}
+
+int or_background_sync3d(OrBackground *bg, SDL_Renderer *rnd, const OcBodies *b, const OcOrient *o,
+                         const OcCamera *cam, int w, int h) {
+    if (!bg->tex || bg->w != w || bg->h != h) {
+        if (bg->tex) SDL_DestroyTexture(bg->tex);
+        bg->tex = SDL_CreateTexture(rnd, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
+        if (!bg->tex) return 0;
+        bg->w = w; bg->h = h;
+    }
+    int segs = bg->segments, m = segs + 1;
+    if (!bg->scratch && !(bg->scratch = malloc(sizeof(SDL_Point) * m))) return 0;
+    /* world points of one orbit, their projection and depth scale */
+    double *wx = malloc(sizeof(double) * 5 * (size_t)m);
+    float *k = malloc(sizeof(float) * (size_t)m);
+    if (!wx || !k) { free(wx); free(k); return 0; }
+    double *wy = wx + m, *wz = wy + m, *px = wz + m, *py = px + m;
+    double cx = w / 2.0 + bg->ox, cy = h / 2.0 + bg->oy;
+    bg->key_ox = bg->ox; bg->key_oy = bg->oy;
+
+    OTR_BEGIN("orbit redraw");
+    SDL_Texture *old = SDL_GetRenderTarget(rnd);
+    SDL_SetRenderTarget(rnd, bg->tex);
+    SDL_SetRenderDrawBlendMode(rnd, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(rnd, 0,0,0,255);
+    SDL_RenderClear(rnd);
+    SDL_SetRenderDrawColor(rnd, orbit_col.r, orbit_col.g, orbit_col.b, orbit_col.a);
+    double sun[3] = { 0, 0, 0 }, sx, sy;
+    float ksun;
+    oc_project(cam, &sun[0], &sun[1], &sun[2], 0, 1, cx, cy, &sx, &sy, &ksun);
+    int drawn = 0;
+    for (int i = 0; i < b->n; ++i) {
+        if (b->parent[i] >= 0) continue;
+        int n = orbit_segments(fmax(b->rx[i], b->ry[i]) * ksun, segs);
+        double step = 2.0 * M_PI / n;
+        for (int s = 0; s <= n; ++s) {
+            double sn, cs;
+            oc_sincos(step * s, &sn, &cs);
+            double u = b->rx[i] * cs, v = b->ry[i] * sn;
+            wx[s] = o->px[i] * u + o->qx[i] * v;
+            wy[s] = o->py[i] * u + o->qy[i] * v;
+            wz[s] = o->pz[i] * u + o->qz[i] * v;
+        }
+        oc_project(cam, wx, wy, wz, 0, n + 1, cx, cy, px, py, k);
+        /* split the polyline where it passes behind the eye */
+        int run = 0;
+        for (int s = 0; s <= n; ++s) {
+            if (k[s] > 0.0f) bg->scratch[run++] = (SDL_Point){ (int)lround(px[s]), (int)lround(py[s]) };
+            if ((k[s] <= 0.0f || s == n) && run > 0) {
+                if (run > 1) SDL_RenderDrawLines(rnd, bg->scratch, run);
+                run = 0;
+            }
+        }
+        ++drawn;
+    }
+    if (ksun > 0.0f) {
+        int hs = (int)lround(8.0 * ksun);
+        SDL_Rect r = { (int)lround(sx) - hs, (int)lround(sy) - hs, 2 * hs, 2 * hs };
+        SDL_SetRenderDrawColor(rnd, 255,215,0,255);
+        SDL_RenderFillRect(rnd, &r);
+    }
+    SDL_SetRenderTarget(rnd, old);
+    free(wx); free(k);
+    bg->view3d = 1;
+    OTR_END();
+    return drawn;
+}
+
+#define ATLAS_W 2048
+
+int or_atlas_build(OrAtlas *a, SDL_Renderer *rnd) {
+    /* shelf packing in size order, 1 px gap so filtering never bleeds */
+    int x = 0, y = 0, row = 0;
+    SDL_Rect cell[OR_ATLAS_MAX_SIZE + 1];
+    for (int s = 1; s <= OR_ATLAS_MAX_SIZE; ++s) {
+        if (x + s > ATLAS_W) { x = 0; y += row + 1; row = 0; }
+        cell[s] = (SDL_Rect){ x, y, s, s };
+        x += s + 1;
+        if (s > row) row = s;
+    }
+    int h = y + row;
+    SDL_Texture *tex = SDL_CreateTexture(rnd, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, ATLAS_W, h);
+    if (!tex) return 0;
+    SDL_Texture *old = SDL_GetRenderTarget(rnd);
+    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderTarget(rnd, tex);
+    SDL_SetRenderDrawBlendMode(rnd, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(rnd, 0, 0, 0, 0);
+    SDL_RenderClear(rnd);
+    for (int s = 1; s <= OR_ATLAS_MAX_SIZE; ++s) {
+        /* white modulated by the vertex color; the border is ~30 darker as in
+           or_make_square_texture */
+        SDL_SetRenderDrawColor(rnd, 255, 255, 255, 255);
+        SDL_RenderFillRect(rnd, &cell[s]);
+        SDL_SetRenderDrawColor(rnd, 225, 225, 225, 255);
+        SDL_RenderDrawRect(rnd, &cell[s]);
+        a->uv[s] = (SDL_FRect){ (float)cell[s].x / ATLAS_W, (float)cell[s].y / h,
+                                (float)s / ATLAS_W, (float)s / h };
+    }
+    SDL_SetRenderTarget(rnd, old);
+    if (a->tex) SDL_DestroyTexture(a->tex);
+    a->tex = tex;
+    a->w = ATLAS_W; a->h = h;
+    return 1;
+}
+
+void or_atlas_free(OrAtlas *a) {
+    if (a->tex) SDL_DestroyTexture(a->tex);
+    a->tex = NULL;
+}
+
+void or_atlas_quad(const OrAtlas *a, const OcDrawItem *d, OcColor c, float ox, float oy, float k, SDL_Vertex v[4]) {
+    int s = d->s < 1 ? 1 : d->s > OR_ATLAS_MAX_SIZE ? OR_ATLAS_MAX_SIZE : d->s;
+    const SDL_FRect *uv = &a->uv[s];
+    float h = 0.5f * (float)d->s * k;
+    float cx = ox + ((float)d->x + 0.5f * (float)d->s) * k;
+    float cy = oy + ((float)d->y + 0.5f * (float)d->s) * k;
+    /* clockwise on screen, as SDL_RenderCopyEx */
+    float r = (float)(d->deg * (M_PI / 180.0));
+    float cs = cosf(r) * h, sn = sinf(r) * h;
+    SDL_Color col = { c.r, c.g, c.b, c.a };
+    v[0] = (SDL_Vertex){ { cx - cs + sn, cy - sn - cs }, col, { uv->x, uv->y } };
+    v[1] = (SDL_Vertex){ { cx + cs + sn, cy + sn - cs }, col, { uv->x + uv->w, uv->y } };
+    v[2] = (SDL_Vertex){ { cx - cs - sn, cy - sn + cs }, col, { uv->x, uv->y + uv->h } };
+    v[3] = (SDL_Vertex){ { cx + cs - sn, cy + sn + cs }, col, { uv->x + uv->w, uv->y + uv->h } };
+}
+
+void or_quad_indices(int *idx, int n) {
+    for (int i = 0; i < n; ++i) {
+        int *q = &idx[i*6], b = i*4;
+        q[0] = b; q[1] = b + 1; q[2] = b + 2;
+        q[3] = b + 2; q[4] = b + 1; q[5] = b + 3;
+    }
+}
+
+#define TRAIL_HALF_WIDTH 0.75f
+
+int or_trails_update(OrTrails *tr, SDL_Renderer *rnd, const OcBodies *b, const double *x, const double *y, int w, int h) {
+    if (!tr->tex || tr->w != w || tr->h != h) {
+        if (tr->tex) SDL_DestroyTexture(tr->tex);
+        tr->tex = SDL_CreateTexture(rnd, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
+        if (!tr->tex) return 0;
+        SDL_SetTextureBlendMode(tr->tex, SDL_BLENDMODE_ADD);
+        tr->w = w; tr->h = h;
+        tr->primed = 0;
+    }
+    if (b->n > tr->cap) {
+        int cap = b->cap;
+        if (!grow((void**)&tr->px, sizeof(float), cap) ||
+            !grow((void**)&tr->py, sizeof(float), cap) ||
+            !grow((void**)&tr->verts, sizeof(SDL_Vertex) * 4, cap) ||
+            !grow((void**)&tr->idx, sizeof(int) * 6, cap)) return 0;
+        for (int i = tr->cap; i < cap; ++i) {
+            static const int quad[6] = {0,1,2, 2,1,3};
+            for (int k = 0; k < 6; ++k) tr->idx[i*6 + k] = i*4 + quad[k];
+        }
+        tr->cap = cap;
+    }
+    if (b->n != tr->n) tr->primed = 0;
+
+    SDL_Texture *old = SDL_GetRenderTarget(rnd);
+    SDL_SetRenderTarget(rnd, tr->tex);
+    if (!tr->primed) {
+        SDL_SetRenderDrawBlendMode(rnd, SDL_BLENDMODE_NONE);
+        SDL_SetRenderDrawColor(rnd, 0,0,0,255);
+        SDL_RenderClear(rnd);
+    } else {
+        SDL_SetRenderDrawBlendMode(rnd, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderDrawColor(rnd, 0,0,0,tr->fade);
+        SDL_RenderFillRect(rnd, NULL);
+
+        for (int i = 0; i < b->n; ++i) {
+            float x0 = tr->px[i], y0 = tr->py[i];
+            float x1 = (float)x[i], y1 = (float)y[i];
+            float dx = x1 - x0, dy = y1 - y0;
+            float len = sqrtf(dx*dx + dy*dy);
+            float nx = TRAIL_HALF_WIDTH, ny = 0.0f;
+            if (len > 1e-4f) { nx = -dy / len * TRAIL_HALF_WIDTH; ny = dx / len * TRAIL_HALF_WIDTH; }
+            OcColor c = b->color[i];
+            SDL_Color col = { c.r, c.g, c.b, 255 };
+            SDL_Vertex *v = &tr->verts[i*4];
+            v[0] = (SDL_Vertex){ {x0 + nx, y0 + ny}, col, {0,0} };
+            v[1] = (SDL_Vertex){ {x0 - nx, y0 - ny}, col, {0,0} };
+            v[2] = (SDL_Vertex){ {x1 + nx, y1 + ny}, col, {0,0} };
+            v[3] = (SDL_Vertex){ {x1 - nx, y1 - ny}, col, {0,0} };
+        }
+        SDL_RenderGeometry(rnd, NULL, tr->verts, b->n * 4, tr->idx, b->n * 6);
+    }
+    SDL_SetRenderTarget(rnd, old);
+
+    for (int i = 0; i < b->n; ++i) { tr->px[i] = (float)x[i]; tr->py[i] = (float)y[i]; }
+    tr->n = b->n;
+    tr->primed = 1;
+    return 1;
+}
+
+void or_trails_draw(SDL_Renderer *rnd, const OrTrails *tr) {
+    if (tr->tex && tr->primed) SDL_RenderCopy(rnd, tr->tex, NULL, NULL);
+}
+
+void or_trails_reset(OrTrails *tr) {
+    tr->primed = 0;
+}
+
+void or_trails_free(OrTrails *tr) {
+    if (tr->tex) SDL_DestroyTexture(tr->tex);
+    free(tr->px); free(tr->py); free(tr->verts); free(tr->idx);
+    tr->tex = NULL; tr->px = tr->py = NULL; tr->verts = NULL; tr->idx = NULL;
+    tr->n = tr->cap = 0;
+    tr->primed = 0;
+}
+
+/* nearest pre-rotated frame, tinted; 0 when d->s is not cached */
+static int draw_rotated(SDL_Renderer *rnd, const OrRotCache *rc, OcColor c, const OcDrawItem *d) {
+    int s = d->s;
+    if (s < 1 || s > OR_ATLAS_MAX_SIZE || !rc->tex[s]) return 0;
+    int frames = rot_frames(rc);
+    int q = (int)(lround(d->deg * rc->angles / 360.0) % frames);
+    if (q < 0) q += frames;
+    int bx = rc->box[s], o = bx/2 - s/2;
+    SDL_Rect src = { (q % rc->cols[s]) * bx, (q / rc->cols[s]) * bx, bx, bx };
+    SDL_Rect dst = { d->x - o, d->y - o, bx, bx };
+    SDL_SetTextureColorMod(rc->tex[s], c.r, c.g, c.b);
+    SDL_SetTextureAlphaMod(rc->tex[s], c.a);
+    SDL_RenderCopy(rnd, rc->tex[s], &src, &dst);
+    return 1;
+}
+
+static void draw_body(SDL_Renderer *rnd, const OrSprites *sp, const OcBodies *b, const OcDrawItem *d, int i) {
+    if (sp->rot && draw_rotated(rnd, sp->rot, b->color[i], d)) return;
+    SDL_Rect dst = { d->x, d->y, d->s, d->s };
+    SDL_Texture *tex = i < sp->n ? sp->tex[i] : NULL;
+    if (tex) {
+        SDL_Point center = { d->s/2, d->s/2 };
+        SDL_RenderCopyEx(rnd, tex, NULL, &dst, d->deg, &center, SDL_FLIP_NONE);
+    } else {
+        OcColor c = b->color[i];
+        SDL_SetRenderDrawColor(rnd, c.r, c.g, c.b, c.a);
+        SDL_RenderFillRect(rnd, &dst);
+    }
+}
+
+void or_draw_bodies(SDL_Renderer *rnd, const OrSprites *sp, const OcBodies *b, const OcDrawItem *items, int n) {
+    for (int i = 0; i < n; ++i) draw_body(rnd, sp, b, &items[i], i);
+}
+
+void or_draw_bodies_ordered(SDL_Renderer *rnd, const OrSprites *sp, const OcBodies *b, const OcDrawItem *items,
+                            const int *order, int n) {
+    for (int k = 0; k < n; ++k) {
+        int i = order[k];
+        if (items[i].s > 0) draw_body(rnd, sp, b, &items[i], i);
+    }
+}
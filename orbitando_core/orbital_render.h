@@ -0,0 +1,146 @@
+#ifndef ORBITAL_RENDER_H
+#define ORBITAL_RENDER_H
+
+/* orbital_render.h
+   SDL2 render caches shared by the desktop and WASM front-ends.
+   Both caches remember, per body, what they last put on the GPU (sprite size
+   and color, rounded orbit semi-axes). Re-syncing after a parameter edit only
+   touches the bodies whose look changed: omega/phase edits cost nothing,
+   size/color edits rebuild one sprite, rx/ry edits redraw one orbit.
+*/
+
+#include <SDL2/SDL.h>
+#include "orbital_core.h"
+
+typedef struct OrRotCache OrRotCache;
+
+typedef struct {
+    int n, cap;
+    SDL_Texture **tex;
+    int *key_size;
+    OcColor *key_color;
+    const OrRotCache *rot;   /* optional pre-rotated frames, used when they hold the size */
+} OrSprites;
+
+typedef struct {
+    SDL_Texture *tex;
+    int w, h;
+    int segments;          /* line segments per orbit */
+    int n, cap;
+    int *key_a, *key_b;    /* rounded semi-axes currently drawn into tex */
+    SDL_Point *scratch;    /* segments+1 points */
+    int view3d;            /* tex holds a 3D view (or_background_sync3d) */
+    int ox, oy;            /* sun offset from the texture center (pan), pixels */
+    int key_ox, key_oy;    /* offset tex was drawn with */
+    int hold;              /* panning: a new offset only shifts the blit
+                              (or_background_draw); the redraw waits until
+                              hold is cleared and the next sync */
+} OrBackground;
+
+/* Motion trails: a persistent render target that is faded once per frame by
+   one blended full-screen quad, then receives one segment per body (last
+   position -> new position) in a single SDL_RenderGeometry batch (SDL >= 2.0.18).
+   Only the previous position is stored, so cost is O(N) per frame whatever
+   the trail length. */
+typedef struct {
+    SDL_Texture *tex;
+    int w, h;
+    Uint8 fade;            /* alpha of the black quad; higher = shorter trails */
+    int primed;            /* px/py hold valid positions */
+    int n, cap;
+    float *px, *py;
+    SDL_Vertex *verts;     /* 4 per body */
+    int *idx;              /* 6 per body, filled once on growth */
+} OrTrails;
+
+/* Shared sprite atlas for batched drawing: one white square (with the same
+   darker border as the per-body sprites) per size 1..OR_ATLAS_MAX_SIZE, packed
+   into a single texture. Quads take their color from the vertices, so every
+   body of every system can go out in one SDL_RenderGeometry call. */
+#define OR_ATLAS_MAX_SIZE 200
+
+typedef struct {
+    SDL_Texture *tex;
+    int w, h;
+    SDL_FRect uv[OR_ATLAS_MAX_SIZE + 1];   /* normalized cell of each size */
+} OrAtlas;
+
+/* Pre-rotated sprites, for renderers where SDL_RenderCopyEx rotates every
+   pixel on the CPU (the software renderer, weak GL drivers). Each sprite
+   size in use gets one texture holding a white square (border as in the
+   atlas) pre-rendered at angles discrete rotations per turn; a body is then
+   an axis-aligned SDL_RenderCopy of the nearest frame, tinted with color
+   and alpha mod. A square repeats every quarter turn, so only angles/4
+   frames are stored. Sizes are built smallest first while the total stays
+   within budget bytes; the rest (and 3D's depth-scaled sizes) keep using
+   SDL_RenderCopyEx. */
+struct OrRotCache {
+    int angles;            /* per turn, multiple of 4; set before the first sync */
+    size_t budget;         /* bytes of texture memory it may use */
+    size_t bytes;          /* in use */
+    int sizes;             /* sizes cached */
+    SDL_Texture *tex[OR_ATLAS_MAX_SIZE + 1];   /* per size, NULL = not cached */
+    int box[OR_ATLAS_MAX_SIZE + 1];            /* frame side in pixels */
+    int cols[OR_ATLAS_MAX_SIZE + 1];           /* frames per texture row */
+};
+
+/* rebuild the sprites whose size/color changed; returns how many were rebuilt */
+int  or_sprites_sync(OrSprites *sp, SDL_Renderer *rnd, const OcBodies *b);
+void or_sprites_free(OrSprites *sp);
+
+/* cache the sizes b uses (within budget), drop the ones it no longer uses;
+   returns how many sizes were built */
+int  or_rotcache_sync(OrRotCache *rc, SDL_Renderer *rnd, const OcBodies *b);
+void or_rotcache_free(OrRotCache *rc);
+
+/* bg->segments must be set before the first sync.
+   Redraws only changed orbits (plus the unchanged ones they overlapped);
+   falls back to a full redraw when most of them changed or the size or the
+   offset changed (the offset only once bg->hold is clear). Orbits whose outline cannot cross the view are skipped,
+   and orbits too large for bg->segments to follow within a pixel (deep
+   zoom) are tessellated only along the arcs near the view, so a zoomed-in
+   redraw costs less than a full one.
+   Returns how many orbits were drawn, 0 when nothing changed. */
+int  or_background_sync(OrBackground *bg, SDL_Renderer *rnd, const OcBodies *b, int w, int h);
+/* copy tex to the target, shifted by how far the offset moved since it was
+   drawn (nonzero only while hold is set); uncovered edges are black */
+void or_background_draw(SDL_Renderer *rnd, const OrBackground *bg);
+void or_background_free(OrBackground *bg);
+
+/* fade the layer and add this frame's segments (x/y from oc_positions) */
+int  or_trails_update(OrTrails *tr, SDL_Renderer *rnd, const OcBodies *b, const double *x, const double *y, int w, int h);
+/* composite the layer additively over the current target */
+void or_trails_draw(SDL_Renderer *rnd, const OrTrails *tr);
+/* drop the stored positions (after parameter edits or re-enabling) */
+void or_trails_reset(OrTrails *tr);
+void or_trails_free(OrTrails *tr);
+
+/* polyline through segments+1 points of an axis-aligned ellipse */
+void or_tessellate_ellipse(int cx, int cy, int a, int b, int segments, SDL_Point *out);
+
+SDL_Texture* or_make_square_texture(SDL_Renderer *rnd, int size, OcColor col);
+
+int  or_atlas_build(OrAtlas *a, SDL_Renderer *rnd);
+void or_atlas_free(OrAtlas *a);
+/* four vertices (0-1-2, 2-1-3 winding, see or_quad_indices) for one draw
+   item, scaled by k around (ox, oy) + k*(x, y); thread-safe */
+void or_atlas_quad(const OrAtlas *a, const OcDrawItem *d, OcColor c, float ox, float oy, float k, SDL_Vertex v[4]);
+/* 6 indices per quad for n quads */
+void or_quad_indices(int *idx, int n);
+
+/* blit the draw list; bodies without a sprite fall back to a filled rect */
+void or_draw_bodies(SDL_Renderer *rnd, const OrSprites *sp, const OcBodies *b, const OcDrawItem *items, int n);
+/* same in the given order (oc_depth_order), skipping items with s = 0 */
+void or_draw_bodies_ordered(SDL_Renderer *rnd, const OrSprites *sp, const OcBodies *b, const OcDrawItem *items,
+                            const int *order, int n);
+
+/* 3D mode: redraw every sun-centered orbit as a projected polyline (moons are
+   left out, as in 2D), with the sun scaled by its depth and projected around
+   the texture center plus (ox, oy). The camera changes the whole picture, so
+   there is no per-orbit diff; callers sync only when the camera or the orbits
+   changed. The next 2D sync redraws everything.
+   Returns how many orbits were drawn. */
+int  or_background_sync3d(OrBackground *bg, SDL_Renderer *rnd, const OcBodies *b, const OcOrient *o,
+                          const OcCamera *cam, int w, int h);
+
+#endif /* ORBITAL_RENDER_H */
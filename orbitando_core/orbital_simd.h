@@ -0,0 +1,117 @@
+#ifndef ORBITAL_SIMD_H
+#define ORBITAL_SIMD_H
+
+/* orbital_simd.h
+   Internal to orbitando_core: what the per-ISA kernel copies need.
+
+   A kernel body is written once as an OC_INLINE function, and OC_VARIANTS
+   stamps out a baseline, an AVX2+FMA and an AVX-512 copy of a thin wrapper
+   around it; the compiler vectorizes each copy for its target. The copy in
+   use is chosen at run time (oc_isa), so a generic -O2 build still runs the
+   wide loops on CPUs that have them.
+
+   Dispatch is on for GCC/Clang on x86-64 outside Windows (MinGW does not keep
+   the stack 32-byte aligned for AVX spills, GCC bug 54412). Elsewhere,
+   including wasm, only the baseline copy exists and oc_isa() reports it.
+
+   oc_sincos/oc_sincosf replace libm in the kernels: a libm call stops the
+   vectorizer, these are branch-free polynomials (Cephes coefficients, quarter
+   turn reduction) accurate to a few ulp for the angles the core produces.
+*/
+
+#include "orbital_core.h"
+#include <math.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__) && !defined(_WIN32)
+#define OC_DISPATCH 1
+#define OC_TARGET_AVX2   __attribute__((target("avx2,fma")))
+#define OC_TARGET_AVX512 __attribute__((target("avx512f,avx512dq,avx512vl,avx2,fma")))
+#else
+#define OC_DISPATCH 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define OC_INLINE static inline __attribute__((always_inline))
+#else
+#define OC_INLINE static inline
+#endif
+
+/* GCC's -O2 only vectorizes loops that need no alias check or remainder
+   loop, which rules out every kernel here; ask for the normal cost model on
+   the kernel copies alone. Clang vectorizes them at -O2 already. */
+#if defined(__GNUC__) && !defined(__clang__)
+#define OC_VECTORIZE __attribute__((optimize("tree-vectorize", "vect-cost-model=dynamic")))
+#else
+#define OC_VECTORIZE
+#endif
+
+/* OC_VARIANTS(name, (params), (args)) defines name_base[, name_avx2, name_avx512],
+   each calling name_body(args) */
+#if OC_DISPATCH
+#define OC_VARIANTS(name, params, args) \
+    OC_VECTORIZE static void name##_base params { name##_body args; } \
+    OC_VECTORIZE OC_TARGET_AVX2 static void name##_avx2 params { name##_body args; } \
+    OC_VECTORIZE OC_TARGET_AVX512 static void name##_avx512 params { name##_body args; }
+#define OC_PICK(name, isa) \
+    ((isa) == OC_ISA_AVX512 ? name##_avx512 : (isa) == OC_ISA_AVX2 ? name##_avx2 : name##_base)
+#else
+#define OC_VARIANTS(name, params, args) \
+    OC_VECTORIZE static void name##_base params { name##_body args; }
+#define OC_PICK(name, isa) ((void)(isa), name##_base)
+#endif
+
+/* Round to nearest with the 1.5*2^mantissa trick: unlike rint() it never
+   becomes a library call, so it vectorizes on every target. Valid for
+   |v| < 2^51 (double) / 2^22 (float); the kernels stay far below that. */
+#if defined(__FLT_EVAL_METHOD__) && __FLT_EVAL_METHOD__ != 0
+/* x87 keeps excess precision and the trick would not round */
+OC_INLINE double oc_round_near(double v) { return rint(v); }
+OC_INLINE float oc_round_nearf(float v) { return rintf(v); }
+#elif defined(__FAST_MATH__)
+/* -ffast-math folds (v + m) - m back to v; rint is inlined (roundpd /
+   frintx) there, as fast-math drops errno and rounding-mode concerns */
+OC_INLINE double oc_round_near(double v) { return __builtin_rint(v); }
+OC_INLINE float oc_round_nearf(float v) { return __builtin_rintf(v); }
+#else
+OC_INLINE double oc_round_near(double v) {
+    const double m = 6755399441055744.0;
+    return (v + m) - m;
+}
+OC_INLINE float oc_round_nearf(float v) {
+    const float m = 12582912.0f;
+    return (v + m) - m;
+}
+#endif
+
+OC_INLINE void oc_sincos(double a, double *s, double *c) {
+    double q = oc_round_near(a * (2.0 / M_PI));
+    int j = (int)q;
+    double r = ((a - q * 1.57079625129699707031) - q * 7.54978941586159635336e-8) - q * 5.39030285815811905290e-15;
+    double z = r * r;
+    double ps = r + r * z * (((((1.58962301576546568060e-10 * z - 2.50507477628578072866e-8) * z
+                + 2.75573136213857245213e-6) * z - 1.98412698295895385996e-4) * z
+                + 8.33333333332211858878e-3) * z - 1.66666666666666307295e-1);
+    double pc = 1.0 - 0.5 * z + z * z * (((((-1.13585365213876817300e-11 * z + 2.08757008419747316778e-9) * z
+                - 2.75573141792967388112e-7) * z + 2.48015872888517045348e-5) * z
+                - 1.38888888888730564116e-3) * z + 4.16666666666665929218e-2);
+    /* quadrant j mod 4 rotates (sin, cos) by quarter turns */
+    double ss = (j & 1) ? pc : ps;
+    double cc = (j & 1) ? ps : pc;
+    *s = (j & 2) ? -ss : ss;
+    *c = ((j + 1) & 2) ? -cc : cc;
+}
+
+OC_INLINE void oc_sincosf(float a, float *s, float *c) {
+    float q = oc_round_nearf(a * (float)(2.0 / M_PI));
+    int j = (int)q;
+    float r = ((a - q * 1.5703125f) - q * 4.837512969970703125e-4f) - q * 7.54978995489188216e-8f;
+    float z = r * r;
+    float ps = r + r * z * ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f);
+    float pc = 1.0f - 0.5f * z + z * z * ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f);
+    float ss = (j & 1) ? pc : ps;
+    float cc = (j & 1) ? ps : pc;
+    *s = (j & 2) ? -ss : ss;
+    *c = ((j + 1) & 2) ? -cc : cc;
+}
+
+#endif /* ORBITAL_SIMD_H */
@@ -0,0 +1,161 @@
+/* orbital_trace.c
+   Per-thread event rings and the Chrome JSON writer (see orbital_trace.h).
+*/
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L   /* clock_gettime under -std=c17 */
+#endif
+#include "orbital_trace.h"
+
+#ifdef ORBITAL_TRACE
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+typedef struct {
+    const char *name;    /* NULL = end event */
+    uint64_t ts_ns;
+} OtrEvent;
+
+typedef struct OtrThread {
+    struct OtrThread *next;
+    int tid;
+    const char *name;
+    _Atomic uint64_t count;   /* events ever recorded; the ring keeps the last OTR_EVENTS */
+    OtrEvent ev[OTR_EVENTS];
+} OtrThread;
+
+static _Atomic(OtrThread*) g_threads = NULL;
+static _Atomic int g_next_tid = 1;
+static _Thread_local OtrThread *t_self = NULL;
+
+static uint64_t now_ns(void) {
+#ifdef _WIN32
+    LARGE_INTEGER c, f;
+    QueryPerformanceCounter(&c);
+    QueryPerformanceFrequency(&f);
+    return (uint64_t)((double)c.QuadPart * 1e9 / (double)f.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static OtrThread* self(void) {
+    if (t_self) return t_self;
+    OtrThread *t = calloc(1, sizeof(OtrThread));
+    if (!t) return NULL;
+    t->tid = atomic_fetch_add(&g_next_tid, 1);
+    OtrThread *head = atomic_load_explicit(&g_threads, memory_order_relaxed);
+    do t->next = head;
+    while (!atomic_compare_exchange_weak_explicit(&g_threads, &head, t, memory_order_release, memory_order_relaxed));
+    t_self = t;
+    return t;
+}
+
+static void record(const char *name) {
+    OtrThread *t = self();
+    if (!t) return;
+    uint64_t c = atomic_load_explicit(&t->count, memory_order_relaxed);
+    OtrEvent *e = &t->ev[c & (OTR_EVENTS - 1)];
+    e->name = name;
+    e->ts_ns = now_ns();
+    atomic_store_explicit(&t->count, c + 1, memory_order_release);
+}
+
+void otr_begin(const char *name) { record(name ? name : "?"); }
+void otr_end(void) { record(NULL); }
+
+void otr_thread_name(const char *name) {
+    OtrThread *t = self();
+    if (t) t->name = name;
+}
+
+/* JSON string body; trace names are plain identifiers but stay safe anyway */
+static void put_escaped(FILE *f, const char *s) {
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') fputc('\\', f);
+        if ((unsigned char)*s >= 0x20) fputc(*s, f);
+    }
+}
+
+/* oldest timestamp still in any ring: the trace starts at 0 */
+static uint64_t first_ts(OtrThread *list) {
+    uint64_t t0 = UINT64_MAX;
+    for (OtrThread *t = list; t; t = t->next) {
+        uint64_t c = atomic_load_explicit(&t->count, memory_order_acquire);
+        uint64_t lo = c > OTR_EVENTS ? c - OTR_EVENTS : 0;
+        if (lo < c && t->ev[lo & (OTR_EVENTS - 1)].ts_ns < t0) t0 = t->ev[lo & (OTR_EVENTS - 1)].ts_ns;
+    }
+    return t0 == UINT64_MAX ? 0 : t0;
+}
+
+int otr_write(FILE *f) {
+    OtrThread *list = atomic_load_explicit(&g_threads, memory_order_acquire);
+    OtrEvent *tmp = malloc(sizeof(OtrEvent) * OTR_EVENTS);
+    if (!tmp) return 0;
+    uint64_t t0 = first_ts(list);
+    const char *sep = "";
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (OtrThread *t = list; t; t = t->next) {
+        if (t->name) {
+            fprintf(f, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"", sep, t->tid);
+            put_escaped(f, t->name);
+            fprintf(f, "\"}}");
+            sep = ",";
+        }
+        /* copy the window, then drop what the writer lapped meanwhile
+           (including the slot of the event it may be writing right now) */
+        uint64_t c = atomic_load_explicit(&t->count, memory_order_acquire);
+        uint64_t lo = c > OTR_EVENTS ? c - OTR_EVENTS : 0;
+        for (uint64_t i = lo; i < c; ++i) tmp[i - lo] = t->ev[i & (OTR_EVENTS - 1)];
+        atomic_thread_fence(memory_order_acquire);
+        uint64_t c2 = atomic_load_explicit(&t->count, memory_order_relaxed) + 1;
+        uint64_t valid = c2 > OTR_EVENTS ? c2 - OTR_EVENTS : 0;
+        if (valid < lo) valid = lo;
+
+        /* an end whose begin fell out of the ring would close the wrong span */
+        int depth = 0;
+        for (uint64_t i = valid; i < c; ++i) {
+            const OtrEvent *e = &tmp[i - lo];
+            if (!e->name) {
+                if (depth == 0) continue;
+                --depth;
+            } else {
+                ++depth;
+            }
+            double us = (double)(int64_t)(e->ts_ns - t0) / 1000.0;
+            if (e->name) {
+                fprintf(f, "%s\n{\"name\":\"", sep);
+                put_escaped(f, e->name);
+                fprintf(f, "\",\"ph\":\"B\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", t->tid, us);
+            } else {
+                fprintf(f, "%s\n{\"ph\":\"E\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", sep, t->tid, us);
+            }
+            sep = ",";
+        }
+    }
+    fprintf(f, "\n]}\n");
+    free(tmp);
+    return !ferror(f);
+}
+
+int otr_dump(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) return 0;
+    int ok = otr_write(f);
+    if (fclose(f) != 0) ok = 0;
+    return ok;
+}
+
+#endif /* ORBITAL_TRACE */
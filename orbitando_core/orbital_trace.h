@@ -0,0 +1,60 @@
+#ifndef ORBITAL_TRACE_H
+#define ORBITAL_TRACE_H
+
+/* orbital_trace.h
+   Timeline tracing for the desktop and WASM front-ends, written out as Chrome
+   trace-event JSON (open in chrome://tracing or ui.perfetto.dev).
+
+   Compiled in only with -DORBITAL_TRACE; otherwise every macro below expands
+   to nothing and orbital_trace.c is empty, so release builds pay nothing.
+
+   Each thread records into its own fixed ring of begin/end events (the last
+   OTR_EVENTS are kept), created on the thread's first event and linked into a
+   global list with one compare-and-swap. Recording is a clock read and a store
+   into the thread's ring: no locks, no allocation after the first event.
+   A dump may run on any thread while the others keep recording; events a
+   writer overwrote during the copy are dropped, not torn.
+
+   Usage (names must be string literals or otherwise outlive the dump):
+     OTR_BEGIN("simulate"); ...; OTR_END();
+     OTR_SCOPE("present") { SDL_RenderPresent(rnd); }   (no return/break out of it)
+     OTR_THREAD_NAME("control");
+     otr_dump("trace.json");
+*/
+
+#include <stdio.h>
+
+#define OTR_EVENTS (1 << 16)   /* per thread, power of two */
+
+#ifdef ORBITAL_TRACE
+
+void otr_begin(const char *name);
+void otr_end(void);
+void otr_thread_name(const char *name);
+/* Chrome JSON of everything recorded so far; 1 = written, 0 = I/O error
+   (always 0 when tracing is compiled out) */
+int  otr_write(FILE *f);
+int  otr_dump(const char *path);
+
+#define OTR_BEGIN(name)       otr_begin(name)
+#define OTR_END()             otr_end()
+#define OTR_THREAD_NAME(name) otr_thread_name(name)
+#define OTR_CAT_(a, b) a##b
+#define OTR_CAT(a, b) OTR_CAT_(a, b)
+#define OTR_SCOPE(name) \
+    for (int OTR_CAT(otr_once_, __LINE__) = (otr_begin(name), 1); OTR_CAT(otr_once_, __LINE__); \
+         OTR_CAT(otr_once_, __LINE__) = (otr_end(), 0))
+
+#else
+
+#define OTR_BEGIN(name)       ((void)0)
+#define OTR_END()             ((void)0)
+#define OTR_THREAD_NAME(name) ((void)0)
+#define OTR_SCOPE(name)
+
+static inline int otr_write(FILE *f) { (void)f; return 0; }
+static inline int otr_dump(const char *path) { (void)path; return 0; }
+
+#endif /* ORBITAL_TRACE */
+
+#endif /* ORBITAL_TRACE_H */
@@ -0,0 +1,58 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# Build otimizado por perfil (PGO) do orbitando (Linux, gcc).
+#   1. compila com -fprofile-generate e roda o orbital_bench como treino
+#      (headless: renderer por software, sem janela). Roda uma vez por nível
+#      de ISA disponível (baseline, avx2, avx512) para que todas as cópias dos
+#      kernels (orbital_simd.h) recebam perfil, não só a desta máquina;
+#   2. recompila com -fprofile-use e gera ./orbitando e ./orbital_bench.
+# O binário continua genérico (-O2, x86-64 básico): o despacho em tempo de
+# execução escolhe AVX2/AVX-512 na máquina onde roda.
+# Uso:
+#   ./build_pgo.sh                # treino padrão
+#   ./build_pgo.sh --max-n 10000  # argumentos extras vão para o orbital_bench de treino
+
+CC="${CC:-gcc}"
+OBJ="obj/pgo"
+CORE_DIR="../orbitando_core"
+SRCS=(orbital.c orbital_input.c orbital_telemetry.c orbital_control.c orbital_sweep.c orbital_bench.c "${CORE_DIR}/orbital_core.c" "${CORE_DIR}/orbital_render.c" "${CORE_DIR}/orbital_trace.c" "${CORE_DIR}/orbital_pick.c")
+# shellcheck disable=SC2207
+CFLAGS=(-O2 -Wall -I"${CORE_DIR}" $(sdl2-config --cflags) $(pkg-config --cflags SDL2_ttf))
+# shellcheck disable=SC2207
+LIBS=($(sdl2-config --libs) $(pkg-config --libs SDL2_ttf) -lm -lrt)
+APP_OBJS=("${OBJ}/orbital.o" "${OBJ}/orbital_input.o" "${OBJ}/orbital_telemetry.o" "${OBJ}/orbital_control.o" "${OBJ}/orbital_sweep.o" "${OBJ}/orbital_core.o" "${OBJ}/orbital_render.o" "${OBJ}/orbital_trace.o" "${OBJ}/orbital_pick.o")
+BENCH_OBJS=("${OBJ}/orbital_bench.o" "${OBJ}/orbital_input.o" "${OBJ}/orbital_core.o" "${OBJ}/orbital_render.o" "${OBJ}/orbital_trace.o" "${OBJ}/orbital_pick.o")
+
+# os .gcda ficam ao lado de cada .o; os dois estágios usam os mesmos caminhos
+compile() {
+  for f in "${SRCS[@]}"; do
+    b="$(basename "${f%.c}")"
+    "${CC}" "${CFLAGS[@]}" "$@" -c "${f}" -o "${OBJ}/${b}.o"
+  done
+}
+
+mkdir -p "${OBJ}"
+rm -f "${OBJ}"/*.o "${OBJ}"/*.gcda
+
+echo "[1/3] Compilando com instrumentação ..."
+compile -fprofile-generate
+"${CC}" "${BENCH_OBJS[@]}" -fprofile-generate -o "${OBJ}/orbital_bench_train" "${LIBS[@]}"
+
+echo "[2/3] Treinando (orbital_bench) ..."
+for ISA in baseline avx2 avx512; do
+  if "${OBJ}/orbital_bench_train" --isa "${ISA}" --reps 3 --warmup 1 "$@" > /dev/null; then
+    echo "  ${ISA}: ok"
+  else
+    echo "  ${ISA}: indisponível nesta CPU, pulando"
+  fi
+done
+
+echo "[3/3] Recompilando com o perfil ..."
+rm -f "${OBJ}"/*.o
+# partial-training: o que o treino não cobre (loop SDL, modal) é otimizado
+# normalmente em vez de tratado como código frio
+compile -fprofile-use -fprofile-partial-training -fprofile-correction -Wno-missing-profile
+"${CC}" "${APP_OBJS[@]}" -o orbitando "${LIBS[@]}"
+"${CC}" "${BENCH_OBJS[@]}" -o orbital_bench "${LIBS[@]}"
+echo "Gerados: ./orbitando ./orbital_bench"
@@ -1,54 +1,416 @@
 /* orbital_sdl2_v1.c
-   Main adapted to call oi_show_modal in a loop.
-   - Modal Cancel (-1) exits program.
-   - Modal OK (1) shows animation.
-   - When animation ends, return to modal preserving the number of objects
-     and the current values (rx, ry, omega, size) so the user can tweak and run again.
+   Main: one loop that runs the animation with the parameter panel
+   (orbital_input.h) drawn over it.
+   - Edits in the panel reach the simulation in the next frame, row by row:
+     existing bodies keep their phase, and only sprites/orbits whose look
+     changed are rebuilt. The simulation never stops while the user types.
+   - Esc hides/shows the panel, Ctrl+D docks it right/left/center, its SAIR
+     button (or closing the window) quits.
+   - Motion trails: start with --trails or toggle with T.
+   - The window is resizable and HiDPI-aware (--fullscreen for wall displays):
+     the scene is drawn at the renderer's pixel size; orbits and the background
+     are refitted only when the size changes.
+   - --telemetry [NAME] publishes every frame's positions to shared memory
+     (orbital_telemetry.h); the render loop never waits for readers.
+   - --control [PATH] accepts live commands on a Unix-domain socket
+     (orbital_control.h), applied at the start of the next frame.
+   - Wheel zooms the 2D view around the pointer and dragging pans it; F4 goes
+     back to the whole system. Bodies and orbits outside the view are culled,
+     so a deep zoom into a crowded region draws only what is on screen.
+   - Hovering a body shows its parameters and live state; clicking selects it
+     (highlighted, and the panel jumps to its row), clicking empty space
+     clears the selection. Picking goes through a grid index of the visible
+     bodies (orbital_pick.h), refreshed only on frames that need a lookup.
+   - Minimized or hidden, the window draws nothing: the loop sleeps and wakes
+     a few times a second for control commands and telemetry, the phases
+     jump by the exact elapsed time (oc_seek). Without focus it runs at
+     about 20 fps.
+   - --3d [DEG] (or F3) tilts each orbit out of the plane, up to DEG degrees
+     of inclination (default 12), and draws the system in perspective with
+     the bodies depth-sorted; drag to orbit the camera, wheel to zoom.
+   - --rotcache [ANGLES] pre-renders each sprite size at ANGLES rotations
+     (default 64) so bodies are drawn with axis-aligned blits, within
+     --rotcache-mb MB of textures (default 64). On by default with the
+     software renderer, where rotated blits are slow; --no-rotcache turns it
+     off.
+   - --sweep SPEC runs a tiled parameter sweep instead (orbital_sweep.h).
+   - Built with -DORBITAL_TRACE, the frame phases are traced (orbital_trace.h)
+     and written as Chrome trace JSON on exit or with F12 (--trace FILE).
 */
 #include <SDL2/SDL.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "orbital_input.h"
+#include "orbital_core.h"
+#include "orbital_render.h"
+#include "orbital_telemetry.h"
+#include "orbital_control.h"
+#include "orbital_trace.h"
+#include "orbital_sweep.h"
+#include "orbital_pick.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+/* initial window size, in points */
 #define WIN_W 1024
 #define WIN_H 768
 
-static void draw_ellipse(SDL_Renderer *rnd, int cx, int cy, int a, int b, SDL_Color col) {
-    SDL_SetRenderDrawColor(rnd, col.r, col.g, col.b, col.a);
-    const int TABLE_SIZE = 360;
-    int px = cx + a, py = cy;
-    for (int i = 0; i <= TABLE_SIZE; ++i) {
-        double t = (2.0 * M_PI * i) / TABLE_SIZE;
-        int x = cx + (int)round(a * cos(t));
-        int y = cy + (int)round(b * sin(t));
-        SDL_RenderDrawLine(rnd, px, py, x, y);
-        px = x; py = y;
+/* Re-read rows [first, last) of the panel output and resize to N bodies.
+   Bodies that already existed keep their current phase. */
+static int rows_to_core(const Body in[], int oldN, int N, int first, int last, OcBodies *sys) {
+    if (!oc_reserve(sys, N)) return 0;
+    for (int i = first; i < last; ++i) {
+        sys->rx[i] = in[i].rx;
+        sys->ry[i] = in[i].ry;
+        if (i >= oldN) sys->ang[i] = in[i].ang;
+        sys->omega[i] = in[i].omega;
+        sys->size[i] = in[i].size;
+        sys->color[i] = (OcColor){ in[i].color.r, in[i].color.g, in[i].color.b, in[i].color.a };
+        sys->parent[i] = in[i].parent;
+    }
+    sys->n = N;
+    return oc_hierarchy_update(sys) < 0;   /* the panel already validated the order */
+}
+
+/* Fit the simulation to a vw x vh pixel drawable. in[] was built for a radius
+   of base0 pixels; orbits scale with the shorter side times the view's zoom,
+   sprite sizes with the pixel density (ratio = pixels per point). */
+static void fit_view(OcBodies *sys, const Body in[], int first, int last, double base0, int vw, int vh, double ratio,
+                     double zoom) {
+    double f = oc_base_radius(vw, vh) / base0 * zoom;
+    for (int i = first; i < last; ++i) {
+        sys->rx[i] = in[i].rx * f;
+        sys->ry[i] = in[i].ry * f;
+        int s = (int)lround(in[i].size * ratio);
+        sys->size[i] = s < 1 ? 1 : s;
+    }
+}
+
+static double pixel_ratio(SDL_Window *win, int vw) {
+    int w, h;
+    SDL_GetWindowSize(win, &w, &h);
+    return w > 0 ? (double)vw / w : 1.0;
+}
+
+/* 2D camera: the fitted layout scaled by zoom around the sun, which sits
+   pan pixels away from the view center. Sprites keep their size, so zooming
+   into a crowded region spreads its bodies apart. */
+typedef struct {
+    int dragging, moved;   /* moved: refit the orbits */
+    double zoom, panx, pany;
+} View2D;
+
+#define ZOOM_MIN 0.25
+#define ZOOM_MAX 1000.0
+
+/* wheel zooms around the pointer, drag pans. Returns 1 if the event was used. */
+static int view2d_event(View2D *v, const SDL_Event *ev, double ratio, int vw, int vh) {
+    switch (ev->type) {
+        case SDL_MOUSEBUTTONDOWN:
+            if (ev->button.button != SDL_BUTTON_LEFT) return 0;
+            v->dragging = 1;
+            return 1;
+        case SDL_MOUSEBUTTONUP:
+            if (!v->dragging) return 0;
+            v->dragging = 0;
+            v->moved = 1;   /* the background was only shifted while dragging */
+            return 1;
+        case SDL_MOUSEMOTION:
+            if (!v->dragging) return 0;
+            v->panx += ev->motion.xrel * ratio;
+            v->pany += ev->motion.yrel * ratio;
+            v->moved = 1;
+            return 1;
+        case SDL_MOUSEWHEEL: {
+            double z = v->zoom * pow(1.25, ev->wheel.y);
+            z = z < ZOOM_MIN ? ZOOM_MIN : z > ZOOM_MAX ? ZOOM_MAX : z;
+            /* keep the point under the pointer in place */
+            int mx, my;
+            SDL_GetMouseState(&mx, &my);
+            double px = mx * ratio - vw/2, py = my * ratio - vh/2;
+            v->panx = px - (px - v->panx) * (z / v->zoom);
+            v->pany = py - (py - v->pany) * (z / v->zoom);
+            v->zoom = z;
+            v->moved = 1;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* 3D view state. orient always covers the N bodies, so tilts set over the
+   control socket survive toggling the view off and on. */
+typedef struct {
+    int on, dragging, dirty;   /* dirty: camera moved, redraw the orbits */
+    double yaw, pitch, zoom;   /* zoom = eye distance / focal length */
+    double max_incl;           /* radians, for the default tilts */
+    OcOrient orient;
+    OcFrame3D frame;
+} View3D;
+
+/* Default plane of bodies [first, last): a fixed pseudo-random tilt per
+   index, so the same system always looks the same. */
+static void orient_defaults(View3D *v, int first, int last) {
+    for (int i = first; i < last; ++i) {
+        unsigned h = (unsigned)i * 2654435761u + 12345u;
+        h ^= h >> 15; h *= 2246822519u; h ^= h >> 13;
+        v->orient.incl[i] = v->max_incl * (h & 0xFFFF) / 65535.0;
+        v->orient.node[i] = 2.0*M_PI * (h >> 16) / 65536.0;
+        v->orient.argp[i] = 0.0;
+    }
+    oc_orient_update(&v->orient, first, last);
+}
+
+/* focal length = 3 orbit radii: mild perspective, flat orbits keep their 2D size at zoom 1 */
+static OcCamera view_camera(const View3D *v, int vw, int vh) {
+    double focal = 3.0 * oc_base_radius(vw, vh);
+    OcCamera cam = { v->yaw, v->pitch, focal * v->zoom, focal };
+    return cam;
+}
+
+static void sync_orbits(OrBackground *bg, SDL_Renderer *rnd, const OcBodies *sys, View3D *v, int vw, int vh) {
+    if (v->on) {
+        OcCamera cam = view_camera(v, vw, vh);
+        or_background_sync3d(bg, rnd, sys, &v->orient, &cam, vw, vh);
+    } else {
+        or_background_sync(bg, rnd, sys, vw, vh);
+    }
+    v->dirty = 0;
+}
+
+/* camera: drag orbits, wheel zooms. Returns 1 if the event was used. */
+static int view_event(View3D *v, const SDL_Event *ev) {
+    if (!v->on) return 0;
+    switch (ev->type) {
+        case SDL_MOUSEBUTTONDOWN:
+            if (ev->button.button != SDL_BUTTON_LEFT) return 0;
+            v->dragging = 1;
+            return 1;
+        case SDL_MOUSEBUTTONUP:
+            if (!v->dragging) return 0;
+            v->dragging = 0;
+            return 1;
+        case SDL_MOUSEMOTION:
+            if (!v->dragging) return 0;
+            v->yaw += ev->motion.xrel * 0.01;
+            v->pitch -= ev->motion.yrel * 0.01;
+            if (v->pitch > M_PI/2) v->pitch = M_PI/2;
+            if (v->pitch < -M_PI/2) v->pitch = -M_PI/2;
+            v->dirty = 1;
+            return 1;
+        case SDL_MOUSEWHEEL:
+            v->zoom *= pow(0.9, ev->wheel.y);
+            if (v->zoom < 0.2) v->zoom = 0.2;
+            if (v->zoom > 10.0) v->zoom = 10.0;
+            v->dirty = 1;
+            return 1;
+    }
+    return 0;
+}
+
+/* Hover and selection. Mouse events are looked at here before the panel and
+   the cameras get them, without consuming them: a left press and release
+   within CLICK_SLOP pixels is a click, anything longer was a drag. */
+#define CLICK_SLOP 4
+
+typedef struct {
+    int hover, selected;        /* body index, -1 = none */
+    int in_scene;               /* pointer over the animation, not the panel */
+    int mx, my;                 /* pointer, pixels */
+    int pressed, press_x, press_y, click;
+    OpIndex index;
+} Picker;
+
+static void pick_event(Picker *p, const SDL_Event *ev, double ratio) {
+    switch (ev->type) {
+        case SDL_MOUSEMOTION:
+            p->mx = (int)(ev->motion.x * ratio);
+            p->my = (int)(ev->motion.y * ratio);
+            p->in_scene = !oi_panel_contains(ev->motion.x, ev->motion.y);
+            break;
+        case SDL_WINDOWEVENT:
+            if (ev->window.event == SDL_WINDOWEVENT_LEAVE) p->in_scene = 0;
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+            if (ev->button.button != SDL_BUTTON_LEFT) break;
+            p->pressed = !oi_panel_contains(ev->button.x, ev->button.y);
+            p->press_x = ev->button.x;
+            p->press_y = ev->button.y;
+            break;
+        case SDL_MOUSEBUTTONUP:
+            if (ev->button.button != SDL_BUTTON_LEFT || !p->pressed) break;
+            p->pressed = 0;
+            if (abs(ev->button.x - p->press_x) + abs(ev->button.y - p->press_y) <= CLICK_SLOP) {
+                p->mx = (int)(ev->button.x * ratio);
+                p->my = (int)(ev->button.y * ratio);
+                p->click = 1;
+            }
+            break;
     }
 }
 
-static SDL_Texture* make_square_texture(SDL_Renderer *rnd, int size, SDL_Color col) {
-    SDL_Texture *tex = SDL_CreateTexture(rnd, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, size, size);
-    if (!tex) return NULL;
-    SDL_Texture *old = SDL_GetRenderTarget(rnd);
-    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
-    SDL_SetRenderTarget(rnd, tex);
+/* frame of the marker around body i: its sprite square plus a margin */
+static void draw_marker(SDL_Renderer *rnd, double x, double y, int s, SDL_Color col) {
+    int h = s / 2 + 4;
+    SDL_Rect r = { (int)lround(x) - h, (int)lround(y) - h, 2 * h, 2 * h };
     SDL_SetRenderDrawBlendMode(rnd, SDL_BLENDMODE_NONE);
     SDL_SetRenderDrawColor(rnd, col.r, col.g, col.b, col.a);
-    SDL_Rect r = {0,0,size,size};
-    SDL_RenderFillRect(rnd, &r);
-    SDL_SetRenderDrawColor(rnd, (Uint8)fmax(0,col.r-30), (Uint8)fmax(0,col.g-30), (Uint8)fmax(0,col.b-30), col.a);
     SDL_RenderDrawRect(rnd, &r);
-    SDL_SetRenderTarget(rnd, old);
-    return tex;
+    r = (SDL_Rect){ r.x - 1, r.y - 1, r.w + 2, r.h + 2 };
+    SDL_RenderDrawRect(rnd, &r);
+}
+
+/* Parameters (panel units) and live state of body i, in a box at (x, y)
+   window points. pos is the body's offset from the sun over the current
+   radius scale, z only in 3D. */
+static void draw_inspector(SDL_Renderer *rnd, double ratio, int x, int y, int i, const Body *b, double base0,
+                           double ang, const double pos[3], int has_z) {
+    char line[3][96];
+    if (b->parent >= 0) snprintf(line[0], sizeof(line[0]), "Obj %d  (orbita %d)", i + 1, b->parent + 1);
+    else snprintf(line[0], sizeof(line[0]), "Obj %d  (orbita o sol)", i + 1);
+    snprintf(line[1], sizeof(line[1]), "Rx %.4f  Ry %.4f  w %.4f  size %d",
+             b->rx / base0, b->ry / base0, b->omega / 0.5, b->size);
+    if (has_z) snprintf(line[2], sizeof(line[2]), "ang %.1f°  x %+.3f  y %+.3f  z %+.3f",
+                        ang * (180.0 / M_PI), pos[0], pos[1], pos[2]);
+    else snprintf(line[2], sizeof(line[2]), "ang %.1f°  x %+.3f  y %+.3f", ang * (180.0 / M_PI), pos[0], pos[1]);
+    SDL_RenderSetScale(rnd, (float)ratio, (float)ratio);
+    SDL_Rect box = { x, y, 330, 3 * 20 + 12 };
+    SDL_SetRenderDrawBlendMode(rnd, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(rnd, 18, 18, 22, 215);
+    SDL_RenderFillRect(rnd, &box);
+    SDL_SetRenderDrawColor(rnd, 110, 110, 130, 255);
+    SDL_RenderDrawRect(rnd, &box);
+    for (int k = 0; k < 3; ++k)
+        oi_draw_text(rnd, x + 8, y + 6 + 20 * k, line[k], k ? (SDL_Color){230,230,230,255} : (SDL_Color){200,220,255,255});
+    SDL_RenderSetScale(rnd, 1.0f, 1.0f);
+}
+
+/* Window visibility. Hidden, the loop waits in SDL_WaitEventTimeout and
+   ticks every HIDDEN_TICK_MS; visible without focus, each frame is followed
+   by a longer delay. */
+#define HIDDEN_TICK_MS 250
+#define BACKGROUND_DELAY_MS 50   /* ~20 fps */
+
+typedef struct { int hidden, focused, resumed; } Visibility;
+
+static void visibility_event(Visibility *v, const SDL_Event *ev) {
+    if (ev->type != SDL_WINDOWEVENT) return;
+    switch (ev->window.event) {
+        case SDL_WINDOWEVENT_MINIMIZED:
+        case SDL_WINDOWEVENT_HIDDEN:
+            v->hidden = 1;
+            break;
+        case SDL_WINDOWEVENT_RESTORED:
+        case SDL_WINDOWEVENT_MAXIMIZED:
+        case SDL_WINDOWEVENT_SHOWN:
+        case SDL_WINDOWEVENT_EXPOSED:
+            v->resumed |= v->hidden;
+            v->hidden = 0;
+            break;
+        case SDL_WINDOWEVENT_FOCUS_GAINED: v->focused = 1; break;
+        case SDL_WINDOWEVENT_FOCUS_LOST:   v->focused = 0; break;
+    }
+}
+
+/* simulation time, driven by the control socket */
+typedef struct { int paused; double speed, t; } SimClock;
+
+enum { RESYNC_SPRITES = 1, RESYNC_ORBITS = 2 };
+
+/* Apply one control command between frames. Values come in panel units and
+   go through bodies[] and the panel's table, so both show them.
+   f = current radius / base0. Returns the RESYNC_ flags it needs. */
+static int apply_control(const OctlCmd *c, Body bodies[], OcBodies *sys, View3D *v, int N, double base0, double f,
+                         double ratio, SimClock *clk) {
+    switch (c->op) {
+        case OCTL_PAUSE:  clk->paused = 1; return 0;
+        case OCTL_RESUME: clk->paused = 0; return 0;
+        case OCTL_SPEED:  clk->speed = c->value; return 0;
+        case OCTL_SEEK:
+            oc_seek(sys, 0, N, c->value - clk->t);
+            clk->t = c->value;
+            return 0;
+        case OCTL_SET: break;
+        default: return 0;
+    }
+    int first = (int)(c->first < (uint32_t)N ? c->first : (uint32_t)N);
+    int last = (c->count >= (uint32_t)(N - first)) ? N : first + (int)c->count;
+    for (int i = first; i < last; ++i) {
+        switch (c->field) {
+            case OCTL_RX:   bodies[i].rx = c->value * base0; sys->rx[i] = bodies[i].rx * f; break;
+            case OCTL_RY:   bodies[i].ry = c->value * base0; sys->ry[i] = bodies[i].ry * f; break;
+            case OCTL_W:    bodies[i].omega = c->value * 0.5; sys->omega[i] = bodies[i].omega; break;
+            case OCTL_SIZE: {
+                bodies[i].size = (int)c->value;
+                int sz = (int)lround(c->value * ratio);
+                sys->size[i] = sz < 1 ? 1 : sz;
+                break;
+            }
+            case OCTL_INCL: v->orient.incl[i] = c->value * (M_PI / 180.0); break;
+            case OCTL_NODE: v->orient.node[i] = c->value * (M_PI / 180.0); break;
+            case OCTL_ARGP: v->orient.argp[i] = c->value * (M_PI / 180.0); break;
+        }
+        if (c->field <= OCTL_SIZE) oi_panel_sync_row(i, &bodies[i], base0);
+    }
+    if (first == last) return 0;
+    if (c->field >= OCTL_INCL) {
+        oc_orient_update(&v->orient, first, last);
+        return v->on ? RESYNC_ORBITS : 0;
+    }
+    return c->field == OCTL_SIZE ? RESYNC_SPRITES : (c->field == OCTL_W ? 0 : RESYNC_ORBITS);
+}
+
+/* per-body sprites plus, when enabled, the pre-rotated frames of the sizes in use */
+static void sync_sprites(OrSprites *sp, OrRotCache *rc, SDL_Renderer *rnd, const OcBodies *sys) {
+    or_sprites_sync(sp, rnd, sys);
+    if (!sp->rot) return;
+    if (or_rotcache_sync(rc, rnd, sys) > 0)
+        printf("rotcache: %d angles, %d sizes, %.1f MB of %.1f MB\n", rc->angles, rc->sizes,
+               rc->bytes / 1048576.0, rc->budget / 1048576.0);
 }
 
 int main(int argc, char *argv[]) {
-    (void)argc; (void)argv;
+    int trails_on = 0;
+    View2D v2 = { .zoom = 1.0 };
+    Picker pk = { .hover = -1, .selected = -1 };
+    Visibility vis = { .focused = 1 };
+    View3D v3 = { .zoom = 1.0, .pitch = -0.9, .max_incl = 12.0 * (M_PI / 180.0) };
+    const char *telemetry = NULL, *control = NULL, *trace = "orbitando_trace.json", *sweep = NULL;
+    int rot_mode = -1;   /* -1 = only with the software renderer */
+    OrRotCache rot = { .angles = 64, .budget = (size_t)64 << 20 };
+    Uint32 win_flags = SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE | SDL_WINDOW_ALLOW_HIGHDPI;
+    for (int a = 1; a < argc; ++a) {
+        if (strcmp(argv[a], "--trails") == 0) trails_on = 1;
+        else if (strcmp(argv[a], "--fullscreen") == 0) win_flags |= SDL_WINDOW_FULLSCREEN_DESKTOP;
+        else if (strcmp(argv[a], "--telemetry") == 0)
+            telemetry = (a + 1 < argc && strncmp(argv[a+1], "--", 2) != 0) ? argv[++a] : OT_DEFAULT_NAME;
+        else if (strcmp(argv[a], "--control") == 0)
+            control = (a + 1 < argc && strncmp(argv[a+1], "--", 2) != 0) ? argv[++a] : OCTL_DEFAULT_PATH;
+        else if (strcmp(argv[a], "--trace") == 0 && a + 1 < argc) trace = argv[++a];
+        else if (strcmp(argv[a], "--sweep") == 0 && a + 1 < argc) sweep = argv[++a];
+        else if (strcmp(argv[a], "--3d") == 0) {
+            v3.on = 1;
+            if (a + 1 < argc && strncmp(argv[a+1], "--", 2) != 0) v3.max_incl = atof(argv[++a]) * (M_PI / 180.0);
+        }
+        else if (strcmp(argv[a], "--rotcache") == 0) {
+            rot_mode = 1;
+            if (a + 1 < argc && strncmp(argv[a+1], "--", 2) != 0) {
+                /* a multiple of 4: the frames repeat every quarter turn */
+                int n = atoi(argv[++a]);
+                rot.angles = n < 4 ? 4 : n > 4096 ? 4096 : (n + 3) / 4 * 4;
+            }
+        }
+        else if (strcmp(argv[a], "--rotcache-mb") == 0 && a + 1 < argc) {
+            double mb = atof(argv[++a]);
+            rot.budget = (size_t)((mb > 0 ? mb : 0) * 1048576.0);
+        }
+        else if (strcmp(argv[a], "--no-rotcache") == 0) rot_mode = 0;
+    }
+    OTR_THREAD_NAME("main");
 
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER) != 0) {
         fprintf(stderr, "SDL_Init failed: %s\n", SDL_GetError());
@@ -56,118 +418,257 @@ int main(int argc, char *argv[]) {
     }
 
     SDL_Window *win = SDL_CreateWindow("ORBITAL SDL2 - Input Enabled", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
-                                       WIN_W, WIN_H, SDL_WINDOW_SHOWN);
+                                       WIN_W, WIN_H, win_flags);
     if (!win) { fprintf(stderr, "SDL_CreateWindow: %s\n", SDL_GetError()); SDL_Quit(); return 1; }
+    SDL_SetWindowMinimumSize(win, 880, 660);   /* the centered panel needs 840x620 */
 
     SDL_Renderer *rnd = SDL_CreateRenderer(win, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
     if (!rnd) { fprintf(stderr, "SDL_CreateRenderer: %s\n", SDL_GetError()); SDL_DestroyWindow(win); SDL_Quit(); return 1; }
 
-    Body bodies[ORBITAL_MAXOBJ];
-    int finalN = 0;
-
-    /* Keep previous values so modal reopens with them.
-       We'll provide them to oi_show_modal via oi_set_defaults when available. */
-    int running_main = 1;
-    while (running_main) {
-        /* If we have previous bodies (finalN>0) pass their relative values as defaults */
-        if (finalN > 0) {
-            double relx[ORBITAL_MAXOBJ];
-            double rely[ORBITAL_MAXOBJ];
-            double wv[ORBITAL_MAXOBJ];
-            int gs[ORBITAL_MAXOBJ];
-            double baseRadius = (WIN_W < WIN_H ? WIN_W : WIN_H) / 2.0 - 30.0;
-            for (int i = 0; i < finalN && i < ORBITAL_MAXOBJ; ++i) {
-                relx[i] = bodies[i].rx / baseRadius;
-                rely[i] = bodies[i].ry / baseRadius;
-                wv[i]   = bodies[i].omega / 0.5;
-                gs[i]   = bodies[i].size / 4;
+    if (sweep) {
+        int rc = osw_run(rnd, sweep, trace);
+        if (otr_dump(trace)) printf("trace: %s\n", trace);
+        oi_text_release();
+        SDL_DestroyRenderer(rnd); SDL_DestroyWindow(win); SDL_Quit();
+        return rc;
+    }
+
+    /* panel output, ORBITAL_MAXOBJ entries; too big for the stack */
+    Body *bodies = malloc(sizeof(Body) * ORBITAL_MAXOBJ);
+    if (!bodies) {
+        fprintf(stderr, "out of memory\n");
+        SDL_DestroyRenderer(rnd); SDL_DestroyWindow(win); SDL_Quit();
+        return 1;
+    }
+
+    /* simulation arrays and GPU caches */
+    OcBodies sys = {0};
+    OcFrame frame = {0};
+    OrSprites sprites = {0};
+    if (rot_mode < 0) {
+        SDL_RendererInfo info;
+        rot_mode = SDL_GetRendererInfo(rnd, &info) == 0 && (info.flags & SDL_RENDERER_SOFTWARE);
+    }
+    if (rot_mode) sprites.rot = &rot;
+    OrBackground bg = { .segments = 360 };
+    OrTrails trails = { .fade = 12 };
+    OtShm tel = {0};
+    if (telemetry && ot_open(&tel, telemetry, ORBITAL_MAXOBJ))
+        printf("telemetry: %s (%d bodies max)\n", telemetry, ORBITAL_MAXOBJ);
+    static OctlServer ctl;   /* the server thread keeps a pointer to it */
+    if (control && octl_start(&ctl, control))
+        printf("control: %s\n", control);
+
+    /* bodies[] rx/ry are in pixels for a radius of base0, fixed for the run;
+       fit_view scales them to the current size */
+    int vw, vh;
+    SDL_GetRendererOutputSize(rnd, &vw, &vh);
+    const double base0 = oc_base_radius(vw, vh);
+    double ratio = pixel_ratio(win, vw);
+    int N = 0;
+
+    oi_panel_set_visible(1);
+    int running = 1, resized = 0;
+    SimClock clk = { 0, 1.0, 0.0 };
+    Uint64 last = SDL_GetPerformanceCounter();
+    double freq = (double)SDL_GetPerformanceFrequency();
+    SDL_Event ev;
+    while (running) {
+        /* a frame that starts hidden is a coarse tick: it takes the exact
+           elapsed time, in closed form, instead of the clamped frame step */
+        int coarse = vis.hidden;
+        if (coarse) OTR_SCOPE("hidden") SDL_WaitEventTimeout(NULL, HIDDEN_TICK_MS);
+        Uint64 now = SDL_GetPerformanceCounter();
+        double dt = (now - last) / freq;
+        last = now;
+        if (dt > 0.1 && !coarse) dt = 0.1;
+
+        OTR_BEGIN("frame");
+        OTR_BEGIN("events");
+        while (SDL_PollEvent(&ev)) {
+            if (ev.type == SDL_QUIT) { running = 0; break; }
+            if (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_F12) {
+                if (otr_dump(trace)) printf("trace: %s\n", trace);
+                else fprintf(stderr, "trace: not written (build with -DORBITAL_TRACE)\n");
+                continue;
+            }
+            if (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_F3) {
+                v3.on = !v3.on;
+                v3.dragging = 0;
+                v3.dirty = 1;
+                v2.dragging = 0;
+                continue;
+            }
+            if (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_F4) {
+                v2 = (View2D){ .zoom = 1.0, .moved = 1 };
+                continue;
+            }
+            if (ev.type == SDL_WINDOWEVENT && ev.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) resized = 1;
+            visibility_event(&vis, &ev);
+            pick_event(&pk, &ev, ratio);
+            int used = oi_panel_event(win, rnd, &ev);
+            if (used < 0) { running = 0; break; }
+            if (used) continue;
+            if (view_event(&v3, &ev)) continue;
+            if (!v3.on && view2d_event(&v2, &ev, ratio, vw, vh)) continue;
+            if (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_ESCAPE) oi_panel_set_visible(!oi_panel_visible());
+            if (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_t) {
+                trails_on = !trails_on;
+                or_trails_reset(&trails);
             }
-            oi_set_defaults(relx, rely, wv, gs, finalN);
+        }
+        OTR_END();
+
+        /* panel edits since the last frame: only the touched rows are re-read */
+        int first, lastrow, oldN = N;
+        N = oi_panel_commit(bodies, base0, &first, &lastrow);
+        if (N != oldN || first < lastrow) {
+            if (!rows_to_core(bodies, oldN, N, first, lastrow, &sys) || !oc_frame_reserve(&frame, N) ||
+                !oc_orient_reserve(&v3.orient, N) || !oc_frame3d_reserve(&v3.frame, N)) {
+                fprintf(stderr, "cannot set up %d bodies\n", N);
+                OTR_END();
+                break;
+            }
+            if (N > oldN) orient_defaults(&v3, oldN, N);
+            if (pk.selected >= N) pk.selected = -1;
+            fit_view(&sys, bodies, first, lastrow, base0, vw, vh, ratio, v2.zoom);
+            sync_sprites(&sprites, &rot, rnd, &sys);
+            sync_orbits(&bg, rnd, &sys, &v3, vw, vh);
+            if (N != oldN) or_trails_reset(&trails);
+        }
+
+        /* new size (or display density): refit once, redraw the background once */
+        if (resized) {
+            resized = 0;
+            SDL_GetRendererOutputSize(rnd, &vw, &vh);
+            ratio = pixel_ratio(win, vw);
+            fit_view(&sys, bodies, 0, N, base0, vw, vh, ratio, v2.zoom);
+            sync_sprites(&sprites, &rot, rnd, &sys);
+            sync_orbits(&bg, rnd, &sys, &v3, vw, vh);
+            or_trails_reset(&trails);
         }
 
-        int rc = oi_show_modal(win, rnd, bodies, &finalN);
-        if (rc == -1) break; /* user cancelled -> exit */
-
-        /* rc == 1: user pressed OK and out_bodies (bodies) filled, finalN set.
-           Show animation; when closed, return to modal (loop continues). */
-
-        int N = finalN;
-        if (N < 1) N = 1;
-        if (N > ORBITAL_MAXOBJ) N = ORBITAL_MAXOBJ;
-
-        /* create textures for bodies (use current bodies array) */
-        SDL_Texture *texs[ORBITAL_MAXOBJ] = {0};
-        for (int i = 0; i < N; ++i) texs[i] = make_square_texture(rnd, bodies[i].size, bodies[i].color);
-
-        /* pre-render background with orbits */
-        SDL_Texture *bg = SDL_CreateTexture(rnd, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, WIN_W, WIN_H);
-        if (bg) {
-            SDL_Texture *old = SDL_GetRenderTarget(rnd);
-            SDL_SetRenderTarget(rnd, bg);
-            SDL_SetRenderDrawColor(rnd, 0,0,0,255);
-            SDL_RenderClear(rnd);
-            SDL_Color orbit_col = {64,200,220,255};
-            int cx = WIN_W/2, cy = WIN_H/2;
-            for (int i = 0; i < N; ++i) draw_ellipse(rnd, cx, cy, (int)round(bodies[i].rx), (int)round(bodies[i].ry), orbit_col);
-            SDL_SetRenderDrawColor(rnd, 255,215,0,255);
-            SDL_Rect sun = {cx-8, cy-8, 16, 16};
-            SDL_RenderFillRect(rnd, &sun);
-            SDL_SetRenderTarget(rnd, old);
+        /* zoom/pan: orbits are refitted and redrawn once per frame, however
+           many wheel and motion events came in */
+        if (v2.moved) {
+            v2.moved = 0;
+            fit_view(&sys, bodies, 0, N, base0, vw, vh, ratio, v2.zoom);
+            bg.ox = (int)lround(v2.panx);
+            bg.oy = (int)lround(v2.pany);
+            bg.hold = v2.dragging;   /* redraw the orbits once, on release */
+            v3.dirty = 1;
         }
 
-        /* animation loop */
-        int anim_running = 1;
-        Uint64 last = SDL_GetPerformanceCounter();
-        double freq = (double)SDL_GetPerformanceFrequency();
-        SDL_Event ev;
-        while (anim_running) {
-            Uint64 now = SDL_GetPerformanceCounter();
-            double dt = (now - last) / freq;
-            last = now;
-            if (dt > 0.1) dt = 0.1;
-
-            while (SDL_PollEvent(&ev)) {
-                if (ev.type == SDL_QUIT) { anim_running = 0; break; }
-                if (ev.type == SDL_KEYDOWN && ev.key.keysym.sym == SDLK_ESCAPE) { anim_running = 0; break; }
+        /* control commands queued since the last frame, then one resync */
+        OctlCmd cmd;
+        int resync = 0;
+        while (ctl.thread && octl_pop(&ctl, &cmd))
+            resync |= apply_control(&cmd, bodies, &sys, &v3, N, base0, oc_base_radius(vw, vh) / base0 * v2.zoom,
+                                    ratio, &clk);
+        if (resync & RESYNC_SPRITES) sync_sprites(&sprites, &rot, rnd, &sys);
+        if ((resync & RESYNC_ORBITS) || v3.dirty) { sync_orbits(&bg, rnd, &sys, &v3, vw, vh); or_trails_reset(&trails); }
+
+        if (clk.paused) dt = 0;
+        dt *= clk.speed;
+        clk.t += dt;
+        int cx = vw/2 + bg.ox, cy = vh/2 + bg.oy;
+        OcCamera cam = view_camera(&v3, vw, vh);
+        OcFrame3D *f3 = &v3.frame;
+        OTR_SCOPE("simulate") {
+            if (coarse) oc_seek(&sys, 0, N, dt);
+            else oc_advance(&sys, 0, N, dt);
+            if (v3.on) {
+                oc_positions3d(&sys, &v3.orient, 0, N, f3->wx, f3->wy, f3->wz);
+                oc_propagate3d(&sys, f3->wx, f3->wy, f3->wz);
+                oc_project(&cam, f3->wx, f3->wy, f3->wz, 0, N, cx, cy, frame.x, frame.y, f3->k);
+            } else {
+                oc_positions(&sys, 0, N, cx, cy, frame.x, frame.y);
+                oc_propagate(&sys, cx, cy, frame.x, frame.y);
             }
+        }
+        OTR_SCOPE("telemetry") ot_publish(&tel, N, frame.x, frame.y, sys.ang);
+        if (vis.hidden) { OTR_END(); continue; }
+        if (vis.resumed) {
+            vis.resumed = 0;
+            or_trails_reset(&trails);   /* the bodies jumped */
+        }
+        if (trails_on) OTR_SCOPE("trails") or_trails_update(&trails, rnd, &sys, frame.x, frame.y, vw, vh);
+
+        OTR_SCOPE("background") {
+            or_background_draw(rnd, &bg);
+            if (trails_on) or_trails_draw(rnd, &trails);
+        }
 
-            for (int i = 0; i < N; ++i) {
-                bodies[i].ang += bodies[i].omega * dt;
-                if (bodies[i].ang > 2.0*M_PI) bodies[i].ang -= 2.0*M_PI;
-                if (bodies[i].ang < 0) bodies[i].ang += 2.0*M_PI;
+        /* only bodies that can show up in the view get a draw item */
+        int nv = 0;
+        OTR_SCOPE("cull") nv = oc_cull(&sys, frame.x, frame.y, v3.on ? f3->k : NULL, 0, N, vw, vh, frame.visible);
+        if (v3.on) {
+            /* back to front, so nearer bodies cover farther ones */
+            OTR_SCOPE("depth sort") {
+                oc_build_draw_list3d_at(&sys, frame.visible, nv, frame.x, frame.y, f3->k, frame.items);
+                oc_depth_order(f3, frame.visible, nv);
             }
+            OTR_SCOPE("bodies") or_draw_bodies_ordered(rnd, &sprites, &sys, frame.items, f3->order, nv);
+        } else OTR_SCOPE("bodies") {
+            oc_build_draw_list_at(&sys, frame.visible, nv, frame.x, frame.y, frame.items);
+            or_draw_bodies_ordered(rnd, &sprites, &sys, frame.items, frame.visible, nv);
+        }
 
-            if (bg) SDL_RenderCopy(rnd, bg, NULL, NULL);
-            else { SDL_SetRenderDrawColor(rnd, 0,0,0,255); SDL_RenderClear(rnd); }
-
-            int cx = WIN_W/2, cy = WIN_H/2;
-            for (int i = 0; i < N; ++i) {
-                double x = cx + bodies[i].rx * cos(bodies[i].ang);
-                double y = cy + bodies[i].ry * sin(bodies[i].ang);
-                int s = bodies[i].size;
-                SDL_Rect dst = { (int)round(x - s/2.0), (int)round(y - s/2.0), s, s };
-                if (texs[i]) {
-                    double deg = (bodies[i].ang / (2.0*M_PI)) * 360.0 * 2.0;
-                    SDL_Point center = { s/2, s/2 };
-                    SDL_RenderCopyEx(rnd, texs[i], NULL, &dst, deg, &center, SDL_FLIP_NONE);
-                } else {
-                    SDL_SetRenderDrawColor(rnd, bodies[i].color.r, bodies[i].color.g, bodies[i].color.b, bodies[i].color.a);
-                    SDL_RenderFillRect(rnd, &dst);
+        /* picking: only on frames with the pointer over the scene or a click */
+        pk.hover = -1;
+        if ((pk.in_scene || pk.click) && N > 0) OTR_SCOPE("pick") {
+            const int *drawn = v3.on ? f3->order : frame.visible;
+            if (op_build(&pk.index, frame.items, drawn, nv, vw, vh)) {
+                int hit = op_pick(&pk.index, frame.items, pk.mx, pk.my);
+                if (pk.in_scene) pk.hover = hit;
+                if (pk.click) {
+                    pk.selected = hit;
+                    if (hit >= 0) oi_panel_select_row(hit);
                 }
             }
-
-            SDL_RenderPresent(rnd);
-            SDL_Delay(6);
+            pk.click = 0;
         }
+        int shown = pk.hover >= 0 ? pk.hover : pk.selected;
+        if (shown >= 0) {
+            double scale = oc_base_radius(vw, vh) * v2.zoom, pos[3];
+            if (v3.on) { pos[0] = f3->wx[shown] / scale; pos[1] = f3->wy[shown] / scale; pos[2] = f3->wz[shown] / scale; }
+            else { pos[0] = (frame.x[shown] - cx) / scale; pos[1] = (frame.y[shown] - cy) / scale; pos[2] = 0.0; }
+            if (pk.selected >= 0 && (!v3.on || f3->k[pk.selected] > 0.0f)) {
+                int s = v3.on ? (int)lround(sys.size[pk.selected] * f3->k[pk.selected]) : sys.size[pk.selected];
+                draw_marker(rnd, frame.x[pk.selected], frame.y[pk.selected], s, (SDL_Color){255,215,0,255});
+            }
+            if (pk.hover >= 0 && pk.hover != pk.selected)
+                draw_marker(rnd, frame.x[pk.hover], frame.y[pk.hover], frame.items[pk.hover].s, (SDL_Color){230,230,230,255});
+            /* next to the pointer while hovering, bottom-left for the selection */
+            int bx = (int)(pk.mx / ratio) + 16, by = (int)(pk.my / ratio) + 16;
+            int ww, wh;
+            SDL_GetWindowSize(win, &ww, &wh);
+            if (pk.hover < 0) { bx = 12; by = wh - 84; }
+            if (bx + 330 > ww) bx = ww - 330;
+            if (by + 72 > wh) by = wh - 72;
+            draw_inspector(rnd, ratio, bx, by, shown, &bodies[shown], base0, sys.ang[shown], pos, v3.on);
+        }
+        oi_panel_draw(win, rnd);
 
-        /* free textures and bg, then loop back to modal (preserving bodies/finalN) */
-        for (int i = 0; i < N; ++i) if (texs[i]) { SDL_DestroyTexture(texs[i]); texs[i] = NULL; }
-        if (bg) { SDL_DestroyTexture(bg); bg = NULL; }
-
-        /* Now loop returns to show modal again with current bodies preserved.
-           The loop continues until the user cancels the modal. */
+        OTR_SCOPE("present") SDL_RenderPresent(rnd);
+        OTR_SCOPE("delay") SDL_Delay(vis.focused ? 6 : BACKGROUND_DELAY_MS);
+        OTR_END();
     }
 
+    if (otr_dump(trace)) printf("trace: %s\n", trace);
+    or_sprites_free(&sprites);
+    or_rotcache_free(&rot);
+    or_background_free(&bg);
+    or_trails_free(&trails);
+    ot_close(&tel);
+    octl_stop(&ctl);
+    oc_frame_free(&frame);
+    op_free(&pk.index);
+    oc_frame3d_free(&v3.frame);
+    oc_orient_free(&v3.orient);
+    oc_free(&sys);
+    oi_panel_release();
+    free(bodies);
     SDL_DestroyRenderer(rnd);
     SDL_DestroyWindow(win);
     SDL_Quit();
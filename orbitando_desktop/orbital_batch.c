@@ -0,0 +1,457 @@
+/* orbital_batch.c
+   Headless batch runs for offline studies: every system of a sweep is
+   simulated without a window, many at once on all cores, and each run's
+   metrics go to one columnar results file.
+
+   The sweep is a spec as in --sweep (oi_spec_count, orbital_input.h): a
+   generator line in which any value may be a list, plus mode=..., the
+   integrator the run is stepped with:
+     step     oc_advance every frame, as the desktop loop (phase += w*dt)
+     seek     oc_seek every frame (one fmod per body)
+     compact  float32 positions from the epoch phase (OcCompact), the layout
+              orbital_bench measures (no frontend steps with it yet)
+   e.g.
+     ./orbital_batch --sweep "gen 100,1000,10000 w=0.5,2 kepler=0,1 mode=step,compact" --t1 3600 --out runs.ocol
+
+   Each run steps --t1 seconds of simulation time at --dt (default 1/60 s),
+   computing every body's position per step like a frame of the app, and
+   records:
+     drift_max, drift_end  largest position error against the exact closed
+                           form, checked every --check seconds and at the end
+                           (relative radius units)
+     approaches            windows where two bodies come within --approach
+                           (all pairs, oe_approaches; -1 above --pairs-max bodies)
+     alignments            windows where bodies 1..K (--align K, default 3) line
+                           up with the sun within --tol degrees (oe_alignments)
+     wall_s, events_s      wall time of the stepping and of the event searches
+   Bodies get the app's start phases (i*2pi/N) and w is in panel units.
+
+   Runs are spread over per-thread deques, each sorted largest first (cost
+   ~ N * steps). A thread pops from the front of its own deque; when that is
+   empty it steals from the back of the fullest other one, so a few big runs
+   never leave the other cores idle.
+
+   Output (--out, default orbital_batch.ocol), little-endian:
+     "OCOL", u32 version (1), u32 rows, u32 columns, then per column
+     u8 type ('i' int32, 'd' float64, 's' string), u8 name length, the name
+     and the rows' values back to back; a string column is u32 offsets[rows+1]
+     followed by the bytes. --tsv also prints the table on stdout.
+*/
+#include <SDL2/SDL.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "orbital_core.h"
+#include "orbital_events.h"
+#include "orbital_input.h"
+
+#define CMD_LEN 256
+#define LABEL_LEN 96
+
+enum { MODE_STEP, MODE_SEEK, MODE_COMPACT, MODE_COUNT };
+static const char *const mode_names[MODE_COUNT] = { "step", "seek", "compact" };
+
+typedef struct {
+    double t1, dt, check, approach, tol, dt_min;
+    int align, pairs_max;
+} Opts;
+
+typedef struct {
+    /* plan */
+    int id, n, mode;
+    char gen[CMD_LEN], label[LABEL_LEN], mode_name[8];
+    double cost;
+    /* results, written only by the thread that ran it */
+    int steps, approaches, alignments, failed;
+    double wall_s, events_s, drift_max, drift_end;
+} Run;
+
+typedef struct {
+    SDL_SpinLock lock;
+    int head, tail;      /* order[head, tail) still queued */
+} Deque;
+
+typedef struct {
+    Run *runs;
+    int *order;          /* run indices; each deque owns a slice */
+    Deque *dq;
+    int threads, total;
+    const Opts *o;
+    atomic_int done;
+} Batch;
+
+typedef struct { Batch *b; int id; } Worker;
+
+/* ---- one run ---- */
+
+static int make_system(const char *gen, OcBodies *b) {
+    OiGen g;
+    char msg[128];
+    if (!oi_gen_parse(gen, &g, msg, sizeof(msg)) || !oc_reserve(b, g.n)) return 0;
+    for (int i = 0; i < g.n; ++i) {
+        double rx, ry, w;
+        int size;
+        oi_gen_next(&g, &rx, &ry, &w, &size);
+        b->rx[i] = rx;
+        b->ry[i] = ry;
+        b->omega[i] = w * 0.5;
+        b->size[i] = size;
+        b->color[i] = (OcColor){ 255, 255, 255, 255 };
+        b->parent[i] = -1;
+    }
+    b->n = g.n;
+    oc_hierarchy_update(b);
+    oc_init_phases(b);
+    return 1;
+}
+
+/* largest distance between the stepped positions and the closed form at t */
+static double drift(const OcBodies *b0, double t, const double *x, const double *y, const float *fx, const float *fy) {
+    double worst = 0.0;
+    for (int i = 0; i < b0->n; ++i) {
+        double ex, ey;
+        oe_position(b0, i, t, &ex, &ey);
+        double d = fx ? hypot(fx[i] - ex, fy[i] - ey) : hypot(x[i] - ex, y[i] - ey);
+        if (d > worst) worst = d;
+    }
+    return worst;
+}
+
+static int simulate(Run *r, const Opts *o, const OcBodies *b0, OcBodies *sys) {
+    int n = b0->n;
+    double *x = malloc(sizeof(double) * (size_t)n), *y = malloc(sizeof(double) * (size_t)n);
+    float *fx = NULL, *fy = NULL;
+    OcCompact cmp = {0};
+    int ok = x && y;
+    if (ok && r->mode == MODE_COMPACT) {
+        fx = malloc(sizeof(float) * (size_t)n);
+        fy = malloc(sizeof(float) * (size_t)n);
+        ok = fx && fy && oc_compact_from_bodies(&cmp, sys, 0.0);
+    }
+    int steps = (int)ceil(o->t1 / o->dt - 1e-9);
+    int every = (int)fmax(1.0, floor(o->check / o->dt + 0.5));
+    double freq = (double)SDL_GetPerformanceFrequency(), wall = 0.0;
+    r->drift_max = r->drift_end = 0.0;
+    Uint64 c0 = SDL_GetPerformanceCounter();
+    for (int k = 1; ok && k <= steps; ++k) {
+        double t = k * o->dt;
+        switch (r->mode) {
+            case MODE_STEP: oc_advance(sys, 0, n, o->dt); break;
+            case MODE_SEEK: oc_seek(sys, 0, n, o->dt); break;
+            default:        oc_compact_set_time(&cmp, t); break;
+        }
+        if (r->mode == MODE_COMPACT) {
+            oc_compact_positions(&cmp, 0, n, (float)(t - cmp.t0), 0.0f, 0.0f, fx, fy);
+            oc_compact_propagate(&cmp, 0.0f, 0.0f, fx, fy);
+        } else {
+            oc_positions(sys, 0, n, 0.0, 0.0, x, y);
+            oc_propagate(sys, 0.0, 0.0, x, y);
+        }
+        if (k % every && k < steps) continue;
+        /* the check is not part of the run's time */
+        Uint64 c1 = SDL_GetPerformanceCounter();
+        wall += (c1 - c0) / freq;
+        r->drift_end = drift(b0, t, x, y, fx, fy);
+        if (r->drift_end > r->drift_max) r->drift_max = r->drift_end;
+        c0 = SDL_GetPerformanceCounter();
+    }
+    r->steps = steps;
+    r->wall_s = wall;
+    oc_compact_free(&cmp);
+    free(x); free(y); free(fx); free(fy);
+    return ok;
+}
+
+static int events(Run *r, const Opts *o, const OcBodies *b0) {
+    int n = b0->n;
+    double t1 = r->steps * o->dt;
+    OeEvents ev = {0};
+    Uint64 c0 = SDL_GetPerformanceCounter();
+    r->alignments = r->approaches = -1;
+    if (o->align >= 2 && o->align <= n) {
+        int set[OE_MAX_SET];
+        for (int s = 0; s < o->align; ++s) set[s] = s;
+        r->alignments = oe_alignments(b0, set, o->align, 0.0, t1, o->tol * M_PI / 180.0, 0, o->dt_min, &ev);
+        if (r->alignments < 0) { oe_events_free(&ev); return 0; }
+    }
+    if (o->approach > 0 && n <= o->pairs_max) {
+        r->approaches = 0;
+        for (int i = 0; i < n; ++i) {
+            for (int j = i + 1; j < n; ++j) {
+                ev.n = 0;   /* only the count is kept */
+                int c = oe_approaches(b0, i, j, 0.0, t1, o->approach, o->dt_min, &ev);
+                if (c < 0) { oe_events_free(&ev); return 0; }
+                r->approaches += c;
+            }
+        }
+    }
+    r->events_s = (SDL_GetPerformanceCounter() - c0) / (double)SDL_GetPerformanceFrequency();
+    oe_events_free(&ev);
+    return 1;
+}
+
+static void run_one(Run *r, const Opts *o) {
+    OcBodies b0 = {0}, sys = {0};
+    r->failed = !make_system(r->gen, &b0) || !make_system(r->gen, &sys) ||
+                !simulate(r, o, &b0, &sys) || !events(r, o, &b0);
+    oc_free(&b0);
+    oc_free(&sys);
+}
+
+/* ---- scheduling ---- */
+
+static int pop_own(Batch *b, int t) {
+    Deque *d = &b->dq[t];
+    int r = -1;
+    SDL_AtomicLock(&d->lock);
+    if (d->head < d->tail) r = b->order[d->head++];
+    SDL_AtomicUnlock(&d->lock);
+    return r;
+}
+
+/* the back of the fullest other deque: its smallest remaining run */
+static int steal(Batch *b, int t) {
+    for (;;) {
+        int victim = -1, most = 0;
+        for (int v = 0; v < b->threads; ++v) {
+            if (v == t) continue;
+            SDL_AtomicLock(&b->dq[v].lock);
+            int left = b->dq[v].tail - b->dq[v].head;   /* a hint; taken again below */
+            SDL_AtomicUnlock(&b->dq[v].lock);
+            if (left > most) { most = left; victim = v; }
+        }
+        if (victim < 0) return -1;
+        Deque *d = &b->dq[victim];
+        int r = -1;
+        SDL_AtomicLock(&d->lock);
+        if (d->head < d->tail) r = b->order[--d->tail];
+        SDL_AtomicUnlock(&d->lock);
+        if (r >= 0) return r;
+    }
+}
+
+static int batch_worker(void *p) {
+    Worker *w = p;
+    Batch *b = w->b;
+    for (;;) {
+        int i = pop_own(b, w->id);
+        if (i < 0) i = steal(b, w->id);
+        if (i < 0) break;
+        Run *r = &b->runs[i];
+        run_one(r, b->o);
+        int done = atomic_fetch_add(&b->done, 1) + 1;
+        if (r->failed) fprintf(stderr, "[%d/%d] %s: out of memory\n", done, b->total, r->gen);
+        else fprintf(stderr, "[%d/%d] %s  %.3f s\n", done, b->total, r->label, r->wall_s);
+    }
+    return 0;
+}
+
+typedef struct { double cost; int run; } Ranked;
+
+static int cmp_cost(const void *pa, const void *pb) {
+    const Ranked *a = pa, *b = pb;
+    if (a->cost != b->cost) return (a->cost < b->cost) - (a->cost > b->cost);
+    return a->run - b->run;
+}
+
+/* ---- plan ---- */
+
+/* split mode=... off the generator line; 0 with a message when invalid */
+static int plan_run(Run *r, const char *cmd, const Opts *o) {
+    char tok[64];
+    int used;
+    size_t gl = 0;
+    const char *p = cmd;
+    r->mode = MODE_STEP;
+    r->gen[0] = '\0';
+    while (sscanf(p, "%63s%n", tok, &used) == 1) {
+        p += used;
+        if (strncmp(tok, "mode=", 5) == 0) {
+            int m = 0;
+            while (m < MODE_COUNT && strcmp(tok + 5, mode_names[m]) != 0) ++m;
+            if (m == MODE_COUNT) { fprintf(stderr, "unknown mode %s (step, seek or compact)\n", tok + 5); return 0; }
+            r->mode = m;
+            continue;
+        }
+        gl += (size_t)snprintf(r->gen + gl, gl < CMD_LEN ? CMD_LEN - gl : 0, "%s ", tok);
+        if (gl >= CMD_LEN) { fprintf(stderr, "spec too long\n"); return 0; }
+    }
+    if (gl) r->gen[gl - 1] = '\0';
+    OiGen g;
+    char msg[128];
+    if (!oi_gen_parse(r->gen, &g, msg, sizeof(msg))) { fprintf(stderr, "%s\n", msg); return 0; }
+    r->n = g.n;
+    snprintf(r->mode_name, sizeof(r->mode_name), "%s", mode_names[r->mode]);
+    r->cost = (double)g.n * ceil(o->t1 / o->dt);
+    /* measured: one pair's approach search costs about 50 body-steps per
+       simulated second */
+    if (o->approach > 0 && g.n <= o->pairs_max) r->cost += 0.5 * g.n * (g.n - 1) * o->t1 * 50.0;
+    return 1;
+}
+
+/* ---- output ---- */
+
+typedef struct { const char *name; char type; size_t off; } Column;
+
+static const Column columns[] = {
+    { "run",        'i', offsetof(Run, id) },
+    { "label",      's', offsetof(Run, label) },
+    { "gen",        's', offsetof(Run, gen) },
+    { "mode",       's', offsetof(Run, mode_name) },
+    { "n",          'i', offsetof(Run, n) },
+    { "steps",      'i', offsetof(Run, steps) },
+    { "wall_s",     'd', offsetof(Run, wall_s) },
+    { "drift_max",  'd', offsetof(Run, drift_max) },
+    { "drift_end",  'd', offsetof(Run, drift_end) },
+    { "approaches", 'i', offsetof(Run, approaches) },
+    { "alignments", 'i', offsetof(Run, alignments) },
+    { "events_s",   'd', offsetof(Run, events_s) },
+};
+#define NCOLUMNS ((int)(sizeof(columns) / sizeof(columns[0])))
+
+static void put_u32(FILE *f, uint32_t v) {
+    unsigned char b[4] = { (unsigned char)v, (unsigned char)(v >> 8), (unsigned char)(v >> 16), (unsigned char)(v >> 24) };
+    fwrite(b, 1, 4, f);
+}
+
+static void put_f64(FILE *f, double d) {
+    uint64_t v;
+    memcpy(&v, &d, 8);
+    put_u32(f, (uint32_t)v);
+    put_u32(f, (uint32_t)(v >> 32));
+}
+
+static int write_ocol(const char *path, const Run *runs, int K) {
+    FILE *f = fopen(path, "wb");
+    if (!f) { fprintf(stderr, "cannot write %s\n", path); return 0; }
+    fwrite("OCOL", 1, 4, f);
+    put_u32(f, 1);
+    put_u32(f, (uint32_t)K);
+    put_u32(f, (uint32_t)NCOLUMNS);
+    for (int c = 0; c < NCOLUMNS; ++c) {
+        const Column *col = &columns[c];
+        unsigned char head[2] = { (unsigned char)col->type, (unsigned char)strlen(col->name) };
+        fwrite(head, 1, 2, f);
+        fwrite(col->name, 1, head[1], f);
+        if (col->type == 's') {
+            uint32_t off = 0;
+            put_u32(f, 0);
+            for (int i = 0; i < K; ++i) put_u32(f, off += (uint32_t)strlen((const char*)&runs[i] + col->off));
+            for (int i = 0; i < K; ++i) {
+                const char *s = (const char*)&runs[i] + col->off;
+                fwrite(s, 1, strlen(s), f);
+            }
+        } else {
+            for (int i = 0; i < K; ++i) {
+                const void *v = (const char*)&runs[i] + col->off;
+                if (col->type == 'i') put_u32(f, (uint32_t)*(const int*)v);
+                else put_f64(f, *(const double*)v);
+            }
+        }
+    }
+    int ok = !ferror(f);
+    if (fclose(f) != 0) ok = 0;
+    if (!ok) fprintf(stderr, "error writing %s\n", path);
+    return ok;
+}
+
+static void print_tsv(const Run *runs, int K) {
+    for (int c = 0; c < NCOLUMNS; ++c) printf("%s%s", c ? "\t" : "", columns[c].name);
+    printf("\n");
+    for (int i = 0; i < K; ++i) {
+        for (int c = 0; c < NCOLUMNS; ++c) {
+            const void *v = (const char*)&runs[i] + columns[c].off;
+            if (c) printf("\t");
+            if (columns[c].type == 's') printf("%s", (const char*)v);
+            else if (columns[c].type == 'i') printf("%d", *(const int*)v);
+            else printf("%.6g", *(const double*)v);
+        }
+        printf("\n");
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *spec = NULL, *out = "orbital_batch.ocol";
+    Opts o = { .t1 = 600.0, .dt = 1.0 / 60.0, .check = 10.0, .approach = 0.01, .tol = 1.0, .dt_min = 0.01,
+               .align = 3, .pairs_max = 256 };
+    int threads = 0, tsv = 0;
+    for (int i = 1; i < argc; ++i) {
+        const char *a = argv[i];
+        const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(a, "--tsv") == 0) { tsv = 1; continue; }
+        if (!v) { fprintf(stderr, "missing value for %s\n", a); return 1; }
+        if (strcmp(a, "--sweep") == 0) spec = v;
+        else if (strcmp(a, "--out") == 0) out = v;
+        else if (strcmp(a, "--t1") == 0) o.t1 = atof(v);
+        else if (strcmp(a, "--dt") == 0) o.dt = atof(v);
+        else if (strcmp(a, "--check") == 0) o.check = atof(v);
+        else if (strcmp(a, "--approach") == 0) o.approach = atof(v);
+        else if (strcmp(a, "--pairs-max") == 0) o.pairs_max = atoi(v);
+        else if (strcmp(a, "--align") == 0) o.align = atoi(v);
+        else if (strcmp(a, "--tol") == 0) o.tol = atof(v);
+        else if (strcmp(a, "--dt-min") == 0) o.dt_min = atof(v);
+        else if (strcmp(a, "--threads") == 0) threads = atoi(v);
+        else { fprintf(stderr, "unknown option %s\n", a); return 1; }
+        ++i;
+    }
+    if (!spec) { fprintf(stderr, "give the runs with --sweep \"gen N ... mode=step,seek,compact\"\n"); return 1; }
+    if (!(o.t1 > 0.0) || !(o.dt > 0.0) || !(o.check > 0.0) || !(o.dt_min > 0.0) || !(o.tol >= 0.0) ||
+        o.approach < 0.0 || o.align > OE_MAX_SET || o.t1 / o.dt > 2e9) {
+        fprintf(stderr, "need t1 > 0, 0 < dt <= t1 / 2e9 steps, check > 0, dt-min > 0, tol >= 0, approach >= 0, align <= %d\n", OE_MAX_SET);
+        return 1;
+    }
+
+    long K = oi_spec_count(spec);
+    if (K < 1) { fprintf(stderr, "more than %ld runs\n", OI_SPEC_MAX); return 1; }
+    Run *runs = calloc((size_t)K, sizeof(Run));
+    Ranked *sorted = malloc(sizeof(Ranked) * (size_t)K);
+    int *order = malloc(sizeof(int) * (size_t)K);
+    if (!runs || !sorted || !order) { fprintf(stderr, "out of memory\n"); return 1; }
+    for (long i = 0; i < K; ++i) {
+        char cmd[CMD_LEN];
+        Run *r = &runs[i];
+        r->id = (int)i;
+        if (!oi_spec_expand(spec, i, cmd, sizeof(cmd), r->label, sizeof(r->label))) { fprintf(stderr, "spec too long\n"); return 1; }
+        if (!plan_run(r, cmd, &o)) return 1;
+        sorted[i] = (Ranked){ r->cost, (int)i };
+    }
+
+    /* deal the runs largest first, round robin, so every deque starts with
+       a share of the big ones and ends with small ones to steal */
+    Batch b = { runs, order, NULL, threads, (int)K, &o, 0 };
+    if (b.threads < 1) b.threads = SDL_GetCPUCount();
+    if (b.threads > K) b.threads = (int)K;
+    b.dq = calloc((size_t)b.threads, sizeof(Deque));
+    Worker *w = calloc((size_t)b.threads, sizeof(Worker));
+    SDL_Thread **th = calloc((size_t)b.threads, sizeof(SDL_Thread*));
+    if (!b.dq || !w || !th) { fprintf(stderr, "out of memory\n"); return 1; }
+    qsort(sorted, (size_t)K, sizeof(Ranked), cmp_cost);
+    for (int t = 0, at = 0; t < b.threads; ++t) {
+        b.dq[t].head = b.dq[t].tail = at;
+        for (long j = t; j < K; j += b.threads) order[b.dq[t].tail++] = sorted[j].run;
+        at = b.dq[t].tail;
+        w[t] = (Worker){ &b, t };
+    }
+
+    /* pick the kernels before any worker can race to do it */
+    OcIsa isa = oc_isa();
+    Uint64 c0 = SDL_GetPerformanceCounter();
+    /* the main thread is worker 0, and works alone if no thread could start */
+    for (int t = 1; t < b.threads; ++t) th[t] = SDL_CreateThread(batch_worker, "batch", &w[t]);
+    batch_worker(&w[0]);
+    for (int t = 1; t < b.threads; ++t) if (th[t]) SDL_WaitThread(th[t], NULL);
+    double total = (SDL_GetPerformanceCounter() - c0) / (double)SDL_GetPerformanceFrequency();
+
+    int rc = 0;
+    for (long i = 0; i < K; ++i) if (runs[i].failed) rc = 1;
+    if (!write_ocol(out, runs, (int)K)) rc = 1;
+    else fprintf(stderr, "%ld runs on %d threads (%s) in %.2f s: %s\n", K, b.threads, oc_isa_name(isa), total, out);
+    if (tsv) print_tsv(runs, (int)K);
+    free(th); free(w); free(b.dq);
+    free(runs); free(sorted); free(order);
+    return rc;
+}
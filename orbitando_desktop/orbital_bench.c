@@ -0,0 +1,339 @@
+/* orbital_bench.c
+   Micro-benchmarks for the hot kernels of the desktop app, each timed in
+   isolation for N = 10, 100, ... 1M:
+     advance     oc_advance           (angle update)
+     positions   oc_positions         (ellipse position)
+     drawlist    oc_build_draw_list
+     cull        oc_cull              (view culling, about half the bodies visible)
+     pick        op_build + 64 op_pick (picking index refresh and lookups)
+     ellipse     or_tessellate_ellipse, 360 segments per orbit
+     project3d   oc_positions3d + oc_project (3D mode, tilted orbits)
+     depthsort   oc_depth_order       (3D back-to-front order)
+     parse       oi_parse_row         (the panel's commit path)
+     text        oi_draw_text, uncached and cached (software renderer)
+   Every case runs warmup repetitions first, then timed repetitions on a
+   thread pinned to one CPU; the median is the reported figure.
+
+   Usage:
+     ./orbital_bench [--reps R] [--warmup W] [--cpu K] [--max-n N] [--only KERNEL]
+                     [--isa baseline|avx2|avx512] [--baseline FILE] [--tolerance F]
+   Prints JSON on stdout, one result per line. Save a run as a baseline with
+   ./orbital_bench > bench/baseline-<machine>.json; later runs given
+   --baseline compare against it, mark results slower than the tolerance
+   (default 0.10 = 10%) with "regression":true and exit with status 2.
+   --isa forces the kernel copy (default: the best this CPU supports); the
+   level in use is part of the output, compare baselines of the same level.
+*/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "orbital_core.h"
+#include "orbital_render.h"
+#include "orbital_input.h"
+#include "orbital_pick.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+#define BENCH_W 1024
+#define BENCH_H 768
+#define BENCH_DT 0.016
+#define BENCH_SEGMENTS 360
+#define BENCH_MAXN 1000000
+#define BENCH_MAXRES 64
+
+typedef struct {
+    const char *kernel;
+    int n;
+    double median_ns, min_ns, per_item_ns;
+    double base_ns;          /* baseline per_item_ns, 0 when none */
+} Result;
+
+typedef struct {
+    char kernel[32];
+    int n;
+    double per_item_ns;
+} BaseEntry;
+
+static OcBodies g_sys;
+static OcOrient g_orient;
+static OcFrame3D g_f3;
+static OcCamera g_cam;
+static double *g_x, *g_y;
+static OcDrawItem *g_items;
+static int *g_idx;
+static OpIndex g_pick;
+static SDL_Point *g_pts;
+static SDL_Renderer *g_rnd;
+static SDL_Surface *g_surf;
+
+static Result g_res[BENCH_MAXRES];
+static int g_nres;
+static BaseEntry g_base[BENCH_MAXRES];
+static int g_nbase;
+
+/* ---- kernels: each runs once over n items ---- */
+
+static void k_advance(int n)   { oc_advance(&g_sys, 0, n, BENCH_DT); }
+static void k_positions(int n) { oc_positions(&g_sys, 0, n, BENCH_W/2, BENCH_H/2, g_x, g_y); }
+static void k_drawlist(int n)  { oc_build_draw_list(&g_sys, 0, n, g_x, g_y, g_items); }
+
+static void k_project3d(int n) {
+    oc_positions3d(&g_sys, &g_orient, 0, n, g_f3.wx, g_f3.wy, g_f3.wz);
+    oc_project(&g_cam, g_f3.wx, g_f3.wy, g_f3.wz, 0, n, BENCH_W/2, BENCH_H/2, g_x, g_y, g_f3.k);
+}
+
+static void k_depthsort(int n) { oc_depth_order(&g_f3, NULL, n); }
+
+/* the view is the left half of the bench window: about half the orbits cross it */
+static void k_cull(int n) { oc_cull(&g_sys, g_x, g_y, NULL, 0, n, BENCH_W/2, BENCH_H, g_idx); }
+
+/* indexes every body (g_pick_ids = 0..n-1), as if all were on screen */
+static int *g_pick_ids;
+
+static void k_pick(int n) {
+    op_build(&g_pick, g_items, g_pick_ids, n, BENCH_W, BENCH_H);
+    for (int q = 0; q < 64; ++q) op_pick(&g_pick, g_items, (q * 97) % BENCH_W, (q * 61) % BENCH_H);
+}
+
+static void k_ellipse(int n) {
+    for (int i = 0; i < n; ++i)
+        or_tessellate_ellipse(BENCH_W/2, BENCH_H/2, 20 + (i & 255), 15 + (i & 127), BENCH_SEGMENTS, g_pts);
+}
+
+/* 64 distinct rows, as typed in the panel; output goes to a small ring so
+   the timing is the parsing, not the stores */
+#define PARSE_ROWS 64
+static char g_cells[PARSE_ROWS][OI_ROW_CELLS][16];
+static const char *g_rows[PARSE_ROWS][OI_ROW_CELLS];
+
+static void k_parse(int n) {
+    Body ring[PARSE_ROWS];
+    char err[64];
+    double base = oc_base_radius(BENCH_W, BENCH_H);
+    for (int i = 0; i < n; ++i)
+        if (!oi_parse_row(g_rows[i & (PARSE_ROWS-1)], i, n, base, &ring[i & (PARSE_ROWS-1)], err, sizeof(err))) {
+            fprintf(stderr, "parse: %s\n", err);
+            exit(1);
+        }
+}
+
+/* labels cycle through the 64 Rx strings, like the cells of a panel page */
+static void k_text(int n) {
+    for (int i = 0; i < n; ++i)
+        oi_draw_text(g_rnd, 8 + (i & 7) * 80, 8 + ((i >> 3) & 31) * 20, g_cells[i & (PARSE_ROWS-1)][1], (SDL_Color){230,230,230,255});
+}
+
+/* ---- setup ---- */
+
+static int setup(int n) {
+    if (!oc_reserve(&g_sys, n)) return 0;
+    g_x = malloc(sizeof(double) * n);
+    g_y = malloc(sizeof(double) * n);
+    g_items = malloc(sizeof(OcDrawItem) * n);
+    g_idx = malloc(sizeof(int) * n);
+    g_pick_ids = malloc(sizeof(int) * n);
+    g_pts = malloc(sizeof(SDL_Point) * (BENCH_SEGMENTS + 1));
+    if (!g_x || !g_y || !g_items || !g_idx || !g_pick_ids || !g_pts || !oc_orient_reserve(&g_orient, n) || !oc_frame3d_reserve(&g_f3, n)) return 0;
+    double base = oc_base_radius(BENCH_W, BENCH_H);
+    g_sys.n = n;
+    for (int i = 0; i < n; ++i) {
+        double f = (double)i / (double)n;
+        g_sys.rx[i] = (0.10 + 1.30 * f) * base;
+        g_sys.ry[i] = (0.08 + 1.10 * f) * base;
+        g_sys.omega[i] = (0.6 + 0.9 * ((i * 7919) % 1000) / 1000.0) * 0.5;
+        g_sys.size[i] = 8 + (i % 5) * 4;
+        g_sys.color[i] = (OcColor){255,255,255,255};
+        g_sys.parent[i] = -1;
+    }
+    oc_hierarchy_update(&g_sys);
+    oc_init_phases(&g_sys);
+    for (int i = 0; i < n; ++i) {
+        g_orient.incl[i] = 0.3 * ((i * 4099) % 1000) / 1000.0;
+        g_orient.node[i] = 2.0 * M_PI * ((i * 6151) % 1000) / 1000.0;
+        g_orient.argp[i] = 0.0;
+    }
+    oc_orient_update(&g_orient, 0, n);
+    g_cam = (OcCamera){ 0.4, -0.9, 3.0 * base, 3.0 * base };
+    k_project3d(n);   /* depthsort sorts these depths */
+    oc_positions(&g_sys, 0, n, BENCH_W/2, BENCH_H/2, g_x, g_y);
+    oc_build_draw_list(&g_sys, 0, n, g_x, g_y, g_items);   /* pick indexes these */
+    for (int i = 0; i < n; ++i) g_pick_ids[i] = i;
+
+    for (int r = 0; r < PARSE_ROWS; ++r) {
+        snprintf(g_cells[r][0], 16, "%.2f", 0.08 + 0.02 * r);
+        snprintf(g_cells[r][1], 16, "%.2f", 0.10 + 0.02 * r);
+        snprintf(g_cells[r][2], 16, "%.2f", 0.80 + 0.05 * (r % 8));
+        snprintf(g_cells[r][3], 16, "%d", 16 + 4 * (r % 4));
+        snprintf(g_cells[r][4], 16, "0");
+        for (int k = 0; k < OI_ROW_CELLS; ++k) g_rows[r][k] = g_cells[r][k];
+    }
+
+    /* text goes to an offscreen software renderer: no window or GPU needed */
+    g_surf = SDL_CreateRGBSurfaceWithFormat(0, BENCH_W, BENCH_H, 32, SDL_PIXELFORMAT_ARGB8888);
+    g_rnd = g_surf ? SDL_CreateSoftwareRenderer(g_surf) : NULL;
+    return g_rnd != NULL;
+}
+
+static void pin_to_cpu(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) fprintf(stderr, "warning: could not pin to cpu %d\n", cpu);
+#elif defined(_WIN32)
+    if (!SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu)) fprintf(stderr, "warning: could not pin to cpu %d\n", cpu);
+#else
+    (void)cpu;
+#endif
+}
+
+/* ---- baseline ---- */
+
+static void load_baseline(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) { fprintf(stderr, "cannot open baseline %s\n", path); exit(1); }
+    char line[512];
+    while (fgets(line, sizeof(line), f) && g_nbase < BENCH_MAXRES) {
+        BaseEntry *e = &g_base[g_nbase];
+        const char *k = strstr(line, "\"kernel\":\"");
+        const char *n = strstr(line, "\"n\":");
+        const char *p = strstr(line, "\"ns_per_item\":");
+        if (!k || !n || !p) continue;
+        if (sscanf(k + 10, "%31[^\"]", e->kernel) != 1) continue;
+        if (sscanf(n + 4, "%d", &e->n) != 1) continue;
+        if (sscanf(p + 14, "%lf", &e->per_item_ns) != 1) continue;
+        ++g_nbase;
+    }
+    fclose(f);
+}
+
+static double baseline_for(const char *kernel, int n) {
+    for (int i = 0; i < g_nbase; ++i)
+        if (g_base[i].n == n && strcmp(g_base[i].kernel, kernel) == 0) return g_base[i].per_item_ns;
+    return 0.0;
+}
+
+/* ---- timing ---- */
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void run_case(const char *name, void (*fn)(int), int n, int warmup, int reps) {
+    static double t[256];
+    if (reps > 256) reps = 256;
+    double tick_ns = 1e9 / (double)SDL_GetPerformanceFrequency();
+    for (int r = 0; r < warmup; ++r) fn(n);
+    for (int r = 0; r < reps; ++r) {
+        Uint64 t0 = SDL_GetPerformanceCounter();
+        fn(n);
+        t[r] = (double)(SDL_GetPerformanceCounter() - t0) * tick_ns;
+    }
+    qsort(t, (size_t)reps, sizeof(double), cmp_double);
+    if (g_nres == BENCH_MAXRES) return;
+    Result *res = &g_res[g_nres++];
+    res->kernel = name;
+    res->n = n;
+    res->median_ns = t[reps / 2];
+    res->min_ns = t[0];
+    res->per_item_ns = res->median_ns / n;
+    res->base_ns = baseline_for(name, n);
+}
+
+static void text_uncached(int n) { oi_set_text_cache(0); k_text(n); }
+static void text_cached(int n)   { oi_set_text_cache(1); k_text(n); }
+
+typedef struct { const char *name; void (*fn)(int); int max_n; } Kernel;
+
+/* per-item cost varies by ~5 orders of magnitude; the slow kernels stop
+   early so a full run stays around a minute */
+static const Kernel kernels[] = {
+    { "advance",       k_advance,     1000000 },
+    { "positions",     k_positions,   1000000 },
+    { "drawlist",      k_drawlist,    1000000 },
+    { "cull",          k_cull,        1000000 },
+    { "pick",          k_pick,        1000000 },
+    { "ellipse",       k_ellipse,     10000 },
+    { "project3d",     k_project3d,   1000000 },
+    { "depthsort",     k_depthsort,   1000000 },
+    { "parse",         k_parse,       1000000 },
+    { "text_uncached", text_uncached, 10000 },
+    { "text_cached",   text_cached,   10000 },
+};
+
+int main(int argc, char **argv) {
+    int reps = 15, warmup = 3, cpu = 0, max_n = BENCH_MAXN;
+    double tolerance = 0.10;
+    const char *only = NULL, *baseline = NULL, *isa = NULL;
+    for (int i = 1; i < argc; ++i) {
+        const char *a = argv[i];
+        const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+        if      (strcmp(a, "--reps") == 0 && v)      { reps = atoi(v); ++i; }
+        else if (strcmp(a, "--warmup") == 0 && v)    { warmup = atoi(v); ++i; }
+        else if (strcmp(a, "--cpu") == 0 && v)       { cpu = atoi(v); ++i; }
+        else if (strcmp(a, "--max-n") == 0 && v)     { max_n = atoi(v); ++i; }
+        else if (strcmp(a, "--only") == 0 && v)      { only = v; ++i; }
+        else if (strcmp(a, "--baseline") == 0 && v)  { baseline = v; ++i; }
+        else if (strcmp(a, "--isa") == 0 && v)       { isa = v; ++i; }
+        else if (strcmp(a, "--tolerance") == 0 && v) { tolerance = atof(v); ++i; }
+        else { fprintf(stderr, "unknown option %s\n", a); return 1; }
+    }
+    if (reps < 1) reps = 1;
+    if (max_n > BENCH_MAXN) max_n = BENCH_MAXN;
+    if (max_n < 10) max_n = 10;
+    if (baseline) load_baseline(baseline);
+    if (isa) {
+        int ok = 0;
+        for (int k = OC_ISA_BASELINE; k <= OC_ISA_AVX512; ++k)
+            if (strcmp(isa, oc_isa_name((OcIsa)k)) == 0) { ok = oc_set_isa((OcIsa)k); break; }
+        if (!ok) { fprintf(stderr, "isa %s not available here\n", isa); return 1; }
+    }
+
+    if (SDL_Init(0) != 0) { fprintf(stderr, "SDL_Init: %s\n", SDL_GetError()); return 1; }
+    if (!setup(max_n)) { fprintf(stderr, "setup failed for n=%d\n", max_n); return 1; }
+    pin_to_cpu(cpu);
+
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k) {
+        if (only && strcmp(only, kernels[k].name) != 0) continue;
+        for (int n = 10; n <= max_n && n <= kernels[k].max_n; n *= 10)
+            run_case(kernels[k].name, kernels[k].fn, n, warmup, reps);
+    }
+
+    int regressions = 0;
+    printf("{\"bench\":\"orbital_bench\",\"isa\":\"%s\",\"reps\":%d,\"warmup\":%d,\"cpu\":%d,\"results\":[\n",
+           oc_isa_name(oc_isa()), reps, warmup, cpu);
+    for (int i = 0; i < g_nres; ++i) {
+        const Result *r = &g_res[i];
+        printf("{\"kernel\":\"%s\",\"n\":%d,\"median_ns\":%.0f,\"min_ns\":%.0f,\"ns_per_item\":%.3f",
+               r->kernel, r->n, r->median_ns, r->min_ns, r->per_item_ns);
+        if (r->base_ns > 0.0) {
+            int slow = r->per_item_ns > r->base_ns * (1.0 + tolerance);
+            regressions += slow;
+            printf(",\"baseline_ns_per_item\":%.3f,\"ratio\":%.3f,\"regression\":%s",
+                   r->base_ns, r->per_item_ns / r->base_ns, slow ? "true" : "false");
+        }
+        printf("}%s\n", i + 1 < g_nres ? "," : "");
+    }
+    printf("]}\n");
+    if (regressions) fprintf(stderr, "%d result(s) slower than baseline by more than %.0f%%\n", regressions, tolerance * 100.0);
+
+    oi_text_release();
+    SDL_DestroyRenderer(g_rnd);
+    SDL_FreeSurface(g_surf);
+    free(g_x); free(g_y); free(g_items); free(g_idx); free(g_pick_ids); free(g_pts);
+    op_free(&g_pick);
+    oc_orient_free(&g_orient);
+    oc_frame3d_free(&g_f3);
+    oc_free(&g_sys);
+    SDL_Quit();
+    return regressions ? 2 : 0;
+}
@@ -0,0 +1,295 @@
+/* orbital_control.c
+   Control socket server, see orbital_control.h for the protocol.
+*/
+#include "orbital_control.h"
+#include "orbital_trace.h"
+#include <SDL2/SDL.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#define MAX_CLIENTS 8
+#define BINARY_RECORD 16
+#define MAX_LINE 256
+
+typedef struct {
+    int fd;
+    unsigned char *buf;
+    size_t len, cap;
+} Client;
+
+int octl_pop(OctlServer *s, OctlCmd *out) {
+    uint32_t h = atomic_load_explicit(&s->head, memory_order_relaxed);
+    if (h == atomic_load_explicit(&s->tail, memory_order_acquire)) return 0;
+    *out = s->ring[h & (OCTL_QUEUE - 1)];
+    atomic_store_explicit(&s->head, h + 1, memory_order_release);
+    return 1;
+}
+
+/* Commands of one read are staged past the published tail and made visible
+   together by publish(), so the render loop sees the whole batch or none. */
+typedef struct {
+    OctlServer *s;
+    uint32_t tail;                 /* staged, not yet published */
+} Stage;
+
+static int stage_push(Stage *st, const OctlCmd *c) {
+    uint32_t head = atomic_load_explicit(&st->s->head, memory_order_acquire);
+    if (st->tail - head >= OCTL_QUEUE) return 0;
+    st->s->ring[st->tail & (OCTL_QUEUE - 1)] = *c;
+    ++st->tail;
+    return 1;
+}
+
+static void publish(Stage *st) {
+    atomic_store_explicit(&st->s->tail, st->tail, memory_order_release);
+}
+
+static const char *const field_names[] = { "rx", "ry", "w", "size", "incl", "node", "argp" };
+static const double field_min[] = { 0.01, 0.01, -10.0, 2, 0, -360, -360 };
+static const double field_max[] = { 1.5, 1.5, 10.0, 200, 180, 360, 360 };
+
+static int check_set(const OctlCmd *c, char *err, size_t esz) {
+    if (c->field > OCTL_ARGP) { snprintf(err, esz, "unknown field"); return 0; }
+    if (!(c->value >= field_min[c->field] && c->value <= field_max[c->field])) {
+        snprintf(err, esz, "%s out of range %g..%g", field_names[c->field], field_min[c->field], field_max[c->field]);
+        return 0;
+    }
+    return 1;
+}
+
+/* k, a:b or * (1-based, inclusive) */
+static int parse_range(const char *s, OctlCmd *c) {
+    unsigned a, b;
+    if (strcmp(s, "*") == 0) { c->first = 0; c->count = UINT32_MAX; return 1; }
+    if (sscanf(s, "%u:%u", &a, &b) == 2 && a >= 1 && b >= a) { c->first = a - 1; c->count = b - a + 1; return 1; }
+    if (sscanf(s, "%u", &a) == 1 && a >= 1) { c->first = a - 1; c->count = 1; return 1; }
+    return 0;
+}
+
+static int parse_line(const char *line, OctlCmd *c, char *err, size_t esz) {
+    char verb[16], field[16], range[32];
+    memset(c, 0, sizeof(*c));
+    if (sscanf(line, "%15s", verb) != 1) { snprintf(err, esz, "empty"); return 0; }
+    if (strcmp(verb, "set") == 0) {
+        if (sscanf(line, "%*s %15s %31s %lf", field, range, &c->value) != 3) { snprintf(err, esz, "usage: set rx|ry|w|size|incl|node|argp RANGE VALUE"); return 0; }
+        c->op = OCTL_SET;
+        c->field = 0xFF;
+        for (int k = 0; k <= OCTL_ARGP; ++k) if (strcmp(field, field_names[k]) == 0) c->field = (uint8_t)k;
+        if (!parse_range(range, c)) { snprintf(err, esz, "bad range %s", range); return 0; }
+        return check_set(c, err, esz);
+    }
+    if (strcmp(verb, "pause") == 0) { c->op = OCTL_PAUSE; return 1; }
+    if (strcmp(verb, "resume") == 0) { c->op = OCTL_RESUME; return 1; }
+    if (strcmp(verb, "speed") == 0 || strcmp(verb, "seek") == 0) {
+        c->op = verb[1] == 'p' ? OCTL_SPEED : OCTL_SEEK;
+        if (sscanf(line, "%*s %lf", &c->value) != 1) { snprintf(err, esz, "usage: %s VALUE", verb); return 0; }
+        if (c->op == OCTL_SPEED && !(c->value >= 0 && c->value <= 10)) { snprintf(err, esz, "speed out of range 0..10"); return 0; }
+        if (c->op == OCTL_SEEK && !(c->value >= 0)) { snprintf(err, esz, "seek needs T >= 0"); return 0; }
+        return 1;
+    }
+    snprintf(err, esz, "unknown command %s", verb);
+    return 0;
+}
+
+static int parse_record(const unsigned char *r, OctlCmd *c, char *err, size_t esz) {
+    float v;
+    memset(c, 0, sizeof(*c));
+    c->op = r[0];
+    c->field = r[1];
+    c->first = (uint32_t)r[4] | (uint32_t)r[5] << 8 | (uint32_t)r[6] << 16 | (uint32_t)r[7] << 24;
+    c->count = (uint32_t)r[8] | (uint32_t)r[9] << 8 | (uint32_t)r[10] << 16 | (uint32_t)r[11] << 24;
+    memcpy(&v, r + 12, sizeof(v));   /* x86/ARM are little endian */
+    c->value = v;
+    switch (c->op) {
+        case OCTL_SET: return check_set(c, err, esz);
+        case OCTL_PAUSE: case OCTL_RESUME: return 1;
+        case OCTL_SPEED: if (v >= 0 && v <= 10) return 1; snprintf(err, esz, "speed out of range 0..10"); return 0;
+        case OCTL_SEEK: if (v >= 0) return 1; snprintf(err, esz, "seek needs T >= 0"); return 0;
+        default: snprintf(err, esz, "unknown op %u", c->op); return 0;
+    }
+}
+
+static void reply(int fd, const char *msg) {
+    send(fd, msg, strlen(msg), MSG_NOSIGNAL);
+}
+
+/* Consume every complete message in the client's buffer into the stage.
+   Returns 0 if the client sent something unusable and must be dropped. */
+static int process(Client *cl, Stage *st) {
+    size_t pos = 0;
+    char err[96], out[128];
+    OctlCmd c;
+    while (pos < cl->len) {
+        unsigned char *p = cl->buf + pos;
+        size_t avail = cl->len - pos;
+        if (p[0] == OCTL_BINARY_MAGIC) {
+            if (avail < 3) break;
+            unsigned n = (unsigned)p[1] | (unsigned)p[2] << 8;
+            size_t need = 3 + (size_t)n * BINARY_RECORD;
+            if (avail < need) {
+                if (need > cl->cap) {
+                    unsigned char *nb = realloc(cl->buf, need);
+                    if (!nb) return 0;
+                    cl->buf = nb; cl->cap = need;
+                }
+                break;
+            }
+            uint32_t mark = st->tail;
+            int ok = 1;
+            err[0] = '\0';
+            for (unsigned k = 0; k < n && ok; ++k) {
+                ok = parse_record(p + 3 + (size_t)k * BINARY_RECORD, &c, err, sizeof(err));
+                if (ok && !stage_push(st, &c)) { ok = 0; snprintf(err, sizeof(err), "busy"); }
+            }
+            if (ok) snprintf(out, sizeof(out), "ok %u\n", n);
+            else { st->tail = mark; snprintf(out, sizeof(out), "err %s\n", err); }
+            reply(cl->fd, out);
+            pos += need;
+            continue;
+        }
+        unsigned char *nl = memchr(p, '\n', avail);
+        if (!nl) {
+            if (avail > MAX_LINE) return 0;
+            break;
+        }
+        size_t n = (size_t)(nl - p);
+        char line[MAX_LINE + 1];
+        if (n > MAX_LINE) n = MAX_LINE;
+        memcpy(line, p, n);
+        line[n] = '\0';
+        if (n && line[n-1] == '\r') line[n-1] = '\0';
+        pos += (size_t)(nl - p) + 1;
+        if (line[0] == '\0' || line[0] == '#') continue;
+        if (!parse_line(line, &c, err, sizeof(err))) snprintf(out, sizeof(out), "err %s\n", err);
+        else if (!stage_push(st, &c)) snprintf(out, sizeof(out), "err busy\n");
+        else snprintf(out, sizeof(out), "ok\n");
+        reply(cl->fd, out);
+    }
+    memmove(cl->buf, cl->buf + pos, cl->len - pos);
+    cl->len -= pos;
+    return 1;
+}
+
+static void drop(Client *cl) {
+    close(cl->fd);
+    free(cl->buf);
+    memset(cl, 0, sizeof(*cl));
+    cl->fd = -1;
+}
+
+static int server_thread(void *arg) {
+    OctlServer *s = arg;
+    Client cl[MAX_CLIENTS];
+    for (int k = 0; k < MAX_CLIENTS; ++k) { memset(&cl[k], 0, sizeof(cl[k])); cl[k].fd = -1; }
+    Stage st = { s, atomic_load_explicit(&s->tail, memory_order_relaxed) };
+    OTR_THREAD_NAME("control");
+
+    while (!atomic_load_explicit(&s->stop, memory_order_relaxed)) {
+        struct pollfd pf[MAX_CLIENTS + 1];
+        int map[MAX_CLIENTS + 1], np = 0;
+        pf[np].fd = s->listen_fd; pf[np].events = POLLIN; map[np++] = -1;
+        for (int k = 0; k < MAX_CLIENTS; ++k)
+            if (cl[k].fd >= 0) { pf[np].fd = cl[k].fd; pf[np].events = POLLIN; map[np++] = k; }
+        /* the timeout only bounds how long octl_stop waits */
+        if (poll(pf, (nfds_t)np, 100) <= 0) continue;
+
+        if (pf[0].revents & POLLIN) {
+            int fd = accept(s->listen_fd, NULL, NULL);
+            int k = 0;
+            while (k < MAX_CLIENTS && cl[k].fd >= 0) ++k;
+            if (fd >= 0 && k == MAX_CLIENTS) { reply(fd, "err too many clients\n"); close(fd); }
+            else if (fd >= 0) {
+                cl[k].fd = fd;
+                cl[k].cap = 4096;
+                if (!(cl[k].buf = malloc(cl[k].cap))) drop(&cl[k]);
+            }
+        }
+        for (int i = 1; i < np; ++i) {
+            if (!pf[i].revents) continue;
+            Client *c = &cl[map[i]];
+            if (c->len == c->cap) {
+                unsigned char *nb = realloc(c->buf, c->cap * 2);
+                if (!nb) { drop(c); continue; }
+                c->buf = nb; c->cap *= 2;
+            }
+            ssize_t got = recv(c->fd, c->buf + c->len, c->cap - c->len, 0);
+            if (got <= 0) {
+                if (got < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+                drop(c);
+                continue;
+            }
+            c->len += (size_t)got;
+            OTR_BEGIN("control batch");
+            if (!process(c, &st)) drop(c);
+            publish(&st);
+            OTR_END();
+        }
+    }
+    for (int k = 0; k < MAX_CLIENTS; ++k) if (cl[k].fd >= 0) drop(&cl[k]);
+    return 0;
+}
+
+int octl_start(OctlServer *s, const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) { fprintf(stderr, "control: socket path too long\n"); return 0; }
+    strcpy(addr.sun_path, path);
+    snprintf(s->path, sizeof(s->path), "%s", path);
+    atomic_store(&s->head, 0);
+    atomic_store(&s->tail, 0);
+    atomic_store(&s->stop, 0);
+
+    s->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (s->listen_fd < 0) { perror("control: socket"); return 0; }
+    unlink(path);   /* stale socket from an earlier run */
+    if (bind(s->listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(s->listen_fd, 4) != 0) {
+        perror("control: bind");
+        close(s->listen_fd);
+        return 0;
+    }
+    s->thread = SDL_CreateThread(server_thread, "orbital_control", s);
+    if (!s->thread) {
+        fprintf(stderr, "control: SDL_CreateThread: %s\n", SDL_GetError());
+        close(s->listen_fd);
+        unlink(path);
+        return 0;
+    }
+    return 1;
+}
+
+void octl_stop(OctlServer *s) {
+    if (!s->thread) return;
+    atomic_store(&s->stop, 1);
+    SDL_WaitThread((SDL_Thread*)s->thread, NULL);
+    s->thread = NULL;
+    close(s->listen_fd);
+    unlink(s->path);
+}
+
+#else /* _WIN32 */
+
+int octl_start(OctlServer *s, const char *path) {
+    (void)path;
+    s->thread = NULL;
+    fprintf(stderr, "control: Unix-domain sockets are not supported on this platform\n");
+    return 0;
+}
+
+void octl_stop(OctlServer *s) { (void)s; }
+
+int octl_pop(OctlServer *s, OctlCmd *out) { (void)s; (void)out; return 0; }
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef ORBITAL_CONTROL_H
+#define ORBITAL_CONTROL_H
+
+/* orbital_control.h
+   Optional control server: a Unix-domain socket served by its own thread.
+   Commands are parsed on that thread and handed to the render loop through a
+   single-producer/single-consumer ring; the loop drains it at the start of
+   each frame, so a command shows on screen about one frame after it arrives.
+   Everything that arrives in one read (a batch) is published to the ring at
+   once and therefore applied in the same frame.
+
+   Text protocol, one command per line (bodies are numbered from 1 as in the
+   panel; RANGE is k, a:b or *):
+     set rx|ry|w|size RANGE VALUE    same units and limits as the panel
+     set incl|node|argp RANGE DEG    orbit plane in 3D mode (incl 0..180,
+                                     node/argp -360..360)
+     pause | resume
+     speed F                         simulation time per real second (0..10)
+     seek T                          jump to simulation time T seconds
+   Each line is answered "ok" or "err <reason>".
+
+   Binary batches, for scripts that send many updates: the byte 0xB1, a
+   little-endian uint16 count, then count 16-byte records
+     uint8 op (OCTL_SET..OCTL_SEEK), uint8 field (OCTL_RX..OCTL_ARGP),
+     uint16 reserved, uint32 first (0-based), uint32 count, float value
+   answered with one "ok <count>" or "err <reason>" line.
+
+   Unix only; elsewhere octl_start reports that it is unavailable.
+*/
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define OCTL_DEFAULT_PATH "/tmp/orbitando.sock"
+#define OCTL_QUEUE 4096            /* power of two */
+#define OCTL_BINARY_MAGIC 0xB1
+
+enum { OCTL_SET = 1, OCTL_PAUSE, OCTL_RESUME, OCTL_SPEED, OCTL_SEEK };
+enum { OCTL_RX = 0, OCTL_RY, OCTL_W, OCTL_SIZE, OCTL_INCL, OCTL_NODE, OCTL_ARGP };
+
+typedef struct {
+    uint8_t op, field;
+    uint32_t first, count;         /* 0-based body range; count UINT32_MAX = to the end */
+    double value;
+} OctlCmd;
+
+typedef struct {
+    /* SPSC ring: the control thread writes tail, the render loop writes head */
+    OctlCmd ring[OCTL_QUEUE];
+    _Atomic uint32_t head, tail;
+    _Atomic int stop;
+    int listen_fd;
+    char path[108];
+    void *thread;                  /* SDL_Thread*, NULL = not running */
+} OctlServer;
+
+/* Bind path and start the thread; returns 1, or 0 with a message on stderr.
+   The server must stay at the same address until octl_stop. */
+int  octl_start(OctlServer *s, const char *path);
+void octl_stop(OctlServer *s);
+
+/* Render loop side: next queued command, 1 = *out filled, 0 = queue empty */
+int  octl_pop(OctlServer *s, OctlCmd *out);
+
+#endif /* ORBITAL_CONTROL_H */
@@ -1,10 +1,11 @@
 /* orbital_input.c
-   Modal UI for parameter input using SDL2_ttf (preferred) with bitmap fallback.
+   Parameter panel (overlaid on the animation) using SDL2_ttf (preferred) with bitmap fallback.
    Presents semi-eixo-x (Rx) visually on the left and semi-eixo-y (Ry) on the right.
    Internal storage and parsing remain unchanged: cells[0]=Ry, cells[1]=Rx.
 */
 
 #include "orbital_input.h"
+#include "orbital_trace.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include <stdio.h>
@@ -13,14 +14,8 @@
 #include <math.h>
 #include <ctype.h>
 
-#ifndef WIN_W
-#define WIN_W 1024
-#endif
-#ifndef WIN_H
-#define WIN_H 768
-#endif
-
 #define CELL_BUFSZ 32
+#define GRID_COLS OI_ROW_CELLS
 
 /* Rounded rect + filled circle helpers (scanline approach) */
 static void fill_rounded_rect(SDL_Renderer *r, SDL_Rect R, int radius, SDL_Color col) {
@@ -161,41 +156,107 @@ static int load_fonts_if_needed(void) {
     return (g_font != NULL) || (g_font_title != NULL);
 }
 
+/* Rendered-text cache.
+   The modal redraws the same labels and cell contents every frame; rasterizing
+   them with TTF and uploading a texture each time dominated its frame cost.
+   4-way set associative on (font, color, string), least recently used slot
+   of the set is replaced. Textures belong to the renderer, so a slot only
+   hits for the renderer that created it. */
+#define TEXT_CACHE_SLOTS 256
+#define TEXT_CACHE_WAYS 4
+#define TEXT_CACHE_MAXLEN 64
+typedef struct {
+    SDL_Texture *tex;
+    SDL_Renderer *rnd;
+    TTF_Font *font;
+    SDL_Color col;
+    int w, h;
+    unsigned used;         /* text_clock at last hit */
+    char s[TEXT_CACHE_MAXLEN];
+} TextSlot;
+static TextSlot text_cache[TEXT_CACHE_SLOTS];
+static unsigned text_clock = 0;
+static int text_cache_on = 1;
+
+static unsigned text_hash(const TTF_Font *font, SDL_Color col, const char *s) {
+    unsigned h = 2166136261u ^ (unsigned)(size_t)font;
+    h = (h ^ ((unsigned)col.r | (unsigned)col.g << 8 | (unsigned)col.b << 16 | (unsigned)col.a << 24)) * 16777619u;
+    while (*s) h = (h ^ (unsigned char)*s++) * 16777619u;
+    return h;
+}
+
+static void text_cache_clear(void) {
+    for (int i = 0; i < TEXT_CACHE_SLOTS; ++i) {
+        if (text_cache[i].tex) SDL_DestroyTexture(text_cache[i].tex);
+        text_cache[i].tex = NULL;
+        text_cache[i].s[0] = '\0';
+    }
+}
+
+/* returns 1 when drawn with TTF, 0 when the caller must fall back */
+static int draw_ttf(SDL_Renderer *rnd, TTF_Font *font, int x, int y, const char *s, SDL_Color col) {
+    size_t len = strlen(s);
+    TextSlot *slot = NULL;
+    if (text_cache_on && len < TEXT_CACHE_MAXLEN) {
+        TextSlot *set = &text_cache[(text_hash(font, col, s) % (TEXT_CACHE_SLOTS / TEXT_CACHE_WAYS)) * TEXT_CACHE_WAYS];
+        ++text_clock;
+        for (int k = 0; k < TEXT_CACHE_WAYS; ++k) {
+            TextSlot *c = &set[k];
+            if (c->tex && c->rnd == rnd && c->font == font &&
+                c->col.r == col.r && c->col.g == col.g && c->col.b == col.b && c->col.a == col.a &&
+                strcmp(c->s, s) == 0) {
+                c->used = text_clock;
+                SDL_Rect dst = {x, y, c->w, c->h};
+                SDL_RenderCopy(rnd, c->tex, NULL, &dst);
+                return 1;
+            }
+            if (!slot || !c->tex || (slot->tex && c->used < slot->used)) slot = c;
+        }
+    }
+    OTR_BEGIN("text raster");   /* cache miss: TTF raster + texture upload */
+    SDL_Surface *surf = TTF_RenderUTF8_Blended(font, s, col);
+    if (!surf) { OTR_END(); return 0; }
+    SDL_Texture *tex = SDL_CreateTextureFromSurface(rnd, surf);
+    OTR_END();
+    SDL_Rect dst = {x, y, surf->w, surf->h};
+    SDL_FreeSurface(surf);
+    if (!tex) return 1;
+    SDL_RenderCopy(rnd, tex, NULL, &dst);
+    if (!slot) { SDL_DestroyTexture(tex); return 1; }
+    if (slot->tex) SDL_DestroyTexture(slot->tex);
+    slot->tex = tex; slot->rnd = rnd; slot->font = font; slot->col = col;
+    slot->w = dst.w; slot->h = dst.h; slot->used = text_clock;
+    memcpy(slot->s, s, len + 1);
+    return 1;
+}
+
+void oi_set_text_cache(int enabled) {
+    if (!enabled) text_cache_clear();
+    text_cache_on = enabled;
+}
+
+void oi_text_release(void) {
+    text_cache_clear();
+    if (g_font) { TTF_CloseFont(g_font); g_font = NULL; }
+    if (g_font_title) { TTF_CloseFont(g_font_title); g_font_title = NULL; }
+    if (ttf_inited) { TTF_Quit(); ttf_inited = 0; }
+}
+
 /* forward */
 static void draw_text_any(SDL_Renderer *rnd, int x, int y, const char *s, SDL_Color col);
 static void draw_text_center_any(SDL_Renderer *rnd, SDL_Rect r, const char *s, SDL_Color col);
 
 static void draw_title(SDL_Renderer *rnd, int x, int y, const char *s, SDL_Color col) {
-    if (load_fonts_if_needed() && g_font_title) {
-        SDL_Surface *surf = TTF_RenderUTF8_Blended(g_font_title, s, col);
-        if (surf) {
-            SDL_Texture *tex = SDL_CreateTextureFromSurface(rnd, surf);
-            if (tex) {
-                SDL_Rect dst = {x, y, surf->w, surf->h};
-                SDL_RenderCopy(rnd, tex, NULL, &dst);
-                SDL_DestroyTexture(tex);
-            }
-            SDL_FreeSurface(surf);
-            return;
-        }
-    }
+    if (load_fonts_if_needed() && g_font_title && draw_ttf(rnd, g_font_title, x, y, s, col)) return;
+    draw_text_any(rnd, x, y, s, col);
+}
+
+void oi_draw_text(SDL_Renderer *rnd, int x, int y, const char *s, SDL_Color col) {
     draw_text_any(rnd, x, y, s, col);
 }
 
 static void draw_text_any(SDL_Renderer *rnd, int x, int y, const char *s, SDL_Color col) {
-    if (load_fonts_if_needed() && g_font) {
-        SDL_Surface *surf = TTF_RenderUTF8_Blended(g_font, s, col);
-        if (surf) {
-            SDL_Texture *tex = SDL_CreateTextureFromSurface(rnd, surf);
-            if (tex) {
-                SDL_Rect dst = {x, y, surf->w, surf->h};
-                SDL_RenderCopy(rnd, tex, NULL, &dst);
-                SDL_DestroyTexture(tex);
-            }
-            SDL_FreeSurface(surf);
-            return;
-        }
-    }
+    if (load_fonts_if_needed() && g_font && draw_ttf(rnd, g_font, x, y, s, col)) return;
     int cx = x;
     while (*s) {
         const unsigned char *g = select_fallback_glyph(*s);
@@ -232,47 +293,41 @@ static void draw_panel(SDL_Renderer *rnd, SDL_Rect r, SDL_Color bg, SDL_Color bo
 }
 
 typedef struct { char buf[CELL_BUFSZ]; int valid; } Cell;
-typedef struct { int N; Cell cells[ORBITAL_MAXOBJ * 4]; } Grid;
+/* rows are allocated on demand: cells[row*GRID_COLS + k] for row < cap */
+typedef struct { int N, cap; Cell *cells; } Grid;
+
+/* Table columns left to right and the cell each one edits
+   (storage order stays cells[0]=Ry, cells[1]=Rx). */
+static const int col_cell[GRID_COLS] = {1, 0, 2, 3, 4};
+static const char *const col_title[GRID_COLS] = {"Rx", "Ry", "w", "size", "orbita (0 = sol)"};
 
 /* helper prototypes */
 static void grid_fill_one(Grid *g, int i);
 static void grid_resize(Grid *g, int newN);
 
-/* Persistent state across multiple calls to oi_show_modal:
-   saves last grid contents, toggle state, chosenN, focus and scroll so that when
-   the simulation window is opened and closed, the input modal restores previous state.
-*/
-static Grid _saved_grid;
-static int _saved_use_defaults = 1;
-static int _saved_chosenN = 9;
-static int _saved_focus = 0;
-static int _saved_scroll = 0;
-static int _saved_initialized = 0;
+static int grid_reserve(Grid *g, int rows) {
+    if (rows <= g->cap) return 1;
+    if (rows > ORBITAL_MAXOBJ) return 0;
+    int cap = g->cap ? g->cap : 16;
+    while (cap < rows) cap *= 2;
+    if (cap > ORBITAL_MAXOBJ) cap = ORBITAL_MAXOBJ;
+    Cell *nc = realloc(g->cells, sizeof(Cell) * GRID_COLS * (size_t)cap);
+    if (!nc) return 0;
+    g->cells = nc;
+    g->cap = cap;
+    return 1;
+}
 
 static void grid_fill_defaults(Grid *g, int N) {
-    const double *rxs = opt_relx ? opt_relx : builtin_relx;
-    const double *rys = opt_rely ? opt_rely : builtin_rely;
-    const double *wvs = opt_wv   ? opt_wv   : builtin_wv;
-    const int    *gss = opt_gs   ? opt_gs   : builtin_gs;
-    int cnt = opt_count ? opt_count : builtin_count;
     if (N < 1) N = 1;
     if (N > ORBITAL_MAXOBJ) N = ORBITAL_MAXOBJ;
+    if (!grid_reserve(g, N)) return;
     g->N = N;
-    for (int i = 0; i < N; ++i) {
-        double rx = (i < cnt ? rxs[i] : (0.1 + 0.08 * i));
-        double ry = (i < cnt ? rys[i] : (0.1 + 0.08 * i));
-        double w  = (i < cnt ? wvs[i] : (0.8 + 0.05 * i));
-        int gs = (i < cnt ? gss[i] : (4 + (i % 4)));
-        snprintf(g->cells[i*4 + 0].buf, CELL_BUFSZ, "%.2f", ry);
-        snprintf(g->cells[i*4 + 1].buf, CELL_BUFSZ, "%.2f", rx);
-        snprintf(g->cells[i*4 + 2].buf, CELL_BUFSZ, "%.2f", w);
-        snprintf(g->cells[i*4 + 3].buf, CELL_BUFSZ, "%d", gs*4);
-        for (int k = 0; k < 4; ++k) g->cells[i*4 + k].valid = 1;
-    }
+    for (int i = 0; i < N; ++i) grid_fill_one(g, i);
 }
 
-/* populate defaults for a single object index (preserve others) */
-static void grid_fill_one(Grid *g, int i) {
+/* default cells of object index i (c = that row's GRID_COLS cells) */
+static void default_cells(Cell c[], int i) {
     const double *rxs = opt_relx ? opt_relx : builtin_relx;
     const double *rys = opt_rely ? opt_rely : builtin_rely;
     const double *wvs = opt_wv   ? opt_wv   : builtin_wv;
@@ -282,54 +337,256 @@ static void grid_fill_one(Grid *g, int i) {
     double ry = (i < cnt ? rys[i] : (0.1 + 0.08 * i));
     double w  = (i < cnt ? wvs[i] : (0.8 + 0.05 * i));
     int gs = (i < cnt ? gss[i] : (4 + (i % 4)));
-    snprintf(g->cells[i*4 + 0].buf, CELL_BUFSZ, "%.2f", ry);
-    snprintf(g->cells[i*4 + 1].buf, CELL_BUFSZ, "%.2f", rx);
-    snprintf(g->cells[i*4 + 2].buf, CELL_BUFSZ, "%.2f", w);
-    snprintf(g->cells[i*4 + 3].buf, CELL_BUFSZ, "%d", gs*4);
-    for (int k = 0; k < 4; ++k) g->cells[i*4 + k].valid = 1;
+    snprintf(c[0].buf, CELL_BUFSZ, "%.2f", ry);
+    snprintf(c[1].buf, CELL_BUFSZ, "%.2f", rx);
+    snprintf(c[2].buf, CELL_BUFSZ, "%.2f", w);
+    snprintf(c[3].buf, CELL_BUFSZ, "%d", gs*4);
+    snprintf(c[4].buf, CELL_BUFSZ, "0");
+    for (int k = 0; k < GRID_COLS; ++k) c[k].valid = 1;
+}
+
+/* populate defaults for a single object index (preserve others) */
+static void grid_fill_one(Grid *g, int i) {
+    default_cells(&g->cells[i*GRID_COLS], i);
 }
 
 static void grid_resize(Grid *g, int newN) {
     if (newN < 1) newN = 1;
     if (newN > ORBITAL_MAXOBJ) newN = ORBITAL_MAXOBJ;
+    if (!grid_reserve(g, newN)) return;
     int oldN = g->N;
     if (oldN <= 0) oldN = 0;
-    if (newN == oldN) { g->N = newN; return; }
-    if (newN > oldN) {
-        for (int i = oldN; i < newN; ++i) {
-            grid_fill_one(g, i);
+    for (int i = oldN; i < newN; ++i) grid_fill_one(g, i);
+    g->N = newN;
+}
+
+/* parse and validate one object row (cells in GRID_COLS order); i is 0-based */
+int oi_parse_row(const char *const cells[], int i, int N, double baseRadius, Body *out, char *errmsg, size_t emsz) {
+    const char *sry = cells[0];
+    const char *srx = cells[1];
+    const char *sw  = cells[2];
+    const char *ss  = cells[3];
+    const char *sp  = cells[4];
+    char *end;
+    double ryr = strtod(sry, &end); if (end == sry) { snprintf(errmsg, emsz, "Ry invalid at %d", i+1); return 0; }
+    double rxr = strtod(srx, &end); if (end == srx) { snprintf(errmsg, emsz, "Rx invalid at %d", i+1); return 0; }
+    double omega = strtod(sw, &end); if (end == sw) { snprintf(errmsg, emsz, "Omega invalid at %d", i+1); return 0; }
+    long size = strtol(ss, &end, 10); if (end == ss) { snprintf(errmsg, emsz, "Size invalid at %d", i+1); return 0; }
+    long parent = strtol(sp, &end, 10); if (end == sp) { snprintf(errmsg, emsz, "Parent invalid at %d", i+1); return 0; }
+
+    if (!(ryr >= 0.01 && ryr <= 1.5)) { snprintf(errmsg, emsz, "Ry out of range at %d", i+1); return 0; }
+    if (!(rxr >= 0.01 && rxr <= 1.5)) { snprintf(errmsg, emsz, "Rx out of range at %d", i+1); return 0; }
+    if (!(omega >= -10.0 && omega <= 10.0)) { snprintf(errmsg, emsz, "Omega out of range at %d", i+1); return 0; }
+    if (!(size >= 2 && size <= 200)) { snprintf(errmsg, emsz, "Size out of range at %d", i+1); return 0; }
+    /* topological order: a moon's parent must be an earlier object */
+    if (!(parent >= 0 && parent <= i)) { snprintf(errmsg, emsz, "Parent invalid at %d", i+1); return 0; }
+
+    out->rx = rxr * baseRadius;
+    out->ry = ryr * baseRadius;
+    out->omega = omega * 0.5;
+    out->ang = (double)i * (2.0*M_PI / (double)N);
+    out->size = (int)size;
+    out->color = palette[i % PALETTE_COUNT];
+    out->parent = (int)parent - 1;
+    return 1;
+}
+
+static void set_cell(Cell *c, const char *s, size_t len) {
+    if (len >= CELL_BUFSZ) len = CELL_BUFSZ - 1;
+    memcpy(c->buf, s, len);
+    c->buf[len] = '\0';
+    c->valid = 1;
+}
+
+/* Paste rows from clipboard text, starting at row `row` and growing the grid
+   as needed. One body per line: Rx Ry w size [pai], separated by spaces,
+   tabs, commas or semicolons (the on-screen column order, which is also the
+   web table's). Lines that are not all numbers, like a header, are skipped.
+   Returns how many rows were written. */
+static int grid_paste(Grid *g, int row, const char *text) {
+    int pasted = 0;
+    const char *p = text;
+    while (*p && row < ORBITAL_MAXOBJ) {
+        const char *tok[GRID_COLS]; size_t len[GRID_COLS];
+        int nt = 0, ok = 1;
+        while (*p && *p != '\n') {
+            while (*p == ' ' || *p == '\t' || *p == ',' || *p == ';' || *p == '\r') ++p;
+            if (!*p || *p == '\n') break;
+            const char *s = p;
+            while (*p && *p != '\n' && *p != ' ' && *p != '\t' && *p != ',' && *p != ';' && *p != '\r') ++p;
+            char *end;
+            strtod(s, &end);
+            if (end != p || nt == GRID_COLS) ok = 0;
+            else { tok[nt] = s; len[nt] = (size_t)(p - s); ++nt; }
         }
+        if (*p == '\n') ++p;
+        if (!ok || nt < GRID_COLS - 1) continue;
+        if (row >= g->N) {
+            if (!grid_reserve(g, row + 1)) break;
+            grid_resize(g, row + 1);
+        }
+        Cell *c = &g->cells[row * GRID_COLS];
+        for (int k = 0; k < GRID_COLS - 1; ++k) set_cell(&c[col_cell[k]], tok[k], len[k]);
+        if (nt == GRID_COLS) set_cell(&c[col_cell[GRID_COLS-1]], tok[GRID_COLS-1], len[GRID_COLS-1]);
+        else set_cell(&c[col_cell[GRID_COLS-1]], "0", 1);
+        ++row; ++pasted;
     }
-    g->N = newN;
+    return pasted;
 }
 
-static int grid_to_bodies(const Grid *g, Body out[], int *outN, char *errmsg, size_t emsz) {
-    int N = g->N;
-    double baseRadius = (WIN_W < WIN_H ? WIN_W : WIN_H) / 2.0 - 30.0;
+/* all rows as tab-separated text in the paste format; caller frees */
+static char* grid_copy_text(const Grid *g) {
+    size_t cap = (size_t)g->N * (GRID_COLS * CELL_BUFSZ + 1) + 1;
+    char *s = malloc(cap);
+    if (!s) return NULL;
+    size_t len = 0;
+    for (int i = 0; i < g->N; ++i) {
+        const Cell *c = &g->cells[i * GRID_COLS];
+        len += (size_t)snprintf(s + len, cap - len, "%s\t%s\t%s\t%s\t%s\n",
+                                c[1].buf, c[0].buf, c[2].buf, c[3].buf, c[4].buf);
+    }
+    return s;
+}
+
+static int parse_range(const char *v, double *a, double *b) {
+    if (sscanf(v, "%lf:%lf", a, b) == 2) return 1;
+    if (sscanf(v, "%lf", a) == 1) { *b = *a; return 1; }
+    return 0;
+}
+
+/* Generator command:
+     gen N [rx=a:b] [ry=a:b] [w=w0] [kepler] [size=a:b] [seed=s]
+   rx/ry run linearly from a to b over the rows; w is constant, or with
+   kepler follows Kepler's third law, w = w0 * (r/r_min)^-1.5 with
+   r = max(rx, ry), so w0 is the innermost body's speed; sizes are uniform
+   random integers in [a, b]. Every body orbits the sun.
+   Returns the new N, or 0 with a message. */
+int oi_gen_parse(const char *cmd, OiGen *g, char *msg, size_t msz) {
+    *g = (OiGen){ .rx0 = 0.10, .rx1 = 1.40, .ry0 = 0.08, .ry1 = 1.20, .w0 = 1.0, .s0 = 8, .s1 = 24, .seed = 1 };
+    char tok[64];
+    int used;
+    const char *p = cmd;
+    while (sscanf(p, "%63s%n", tok, &used) == 1) {
+        p += used;
+        char *eq = strchr(tok, '=');
+        const char *v = eq ? eq + 1 : "";
+        if (eq) *eq = '\0';
+        if (strcmp(tok, "gen") == 0) continue;
+        if (!eq && g->n == 0 && sscanf(tok, "%d", &g->n) == 1) continue;
+        if (strcmp(tok, "kepler") == 0 && (!eq || sscanf(v, "%d", &g->kepler) == 1)) { if (!eq) g->kepler = 1; continue; }
+        if (strcmp(tok, "rx") == 0 && parse_range(v, &g->rx0, &g->rx1)) continue;
+        if (strcmp(tok, "ry") == 0 && parse_range(v, &g->ry0, &g->ry1)) continue;
+        if (strcmp(tok, "w") == 0 && sscanf(v, "%lf", &g->w0) == 1) continue;
+        if (strcmp(tok, "size") == 0 && parse_range(v, &g->s0, &g->s1)) continue;
+        if (strcmp(tok, "seed") == 0 && sscanf(v, "%u", &g->seed) == 1) continue;
+        snprintf(msg, msz, "gen: unknown argument %s", tok);
+        return 0;
+    }
+    if (g->n < 1 || g->n > ORBITAL_MAXOBJ) { snprintf(msg, msz, "gen: N must be 1..%d", ORBITAL_MAXOBJ); return 0; }
+    if (fmin(g->rx0, g->rx1) < 0.01 || fmax(g->rx0, g->rx1) > 1.5 || fmin(g->ry0, g->ry1) < 0.01 || fmax(g->ry0, g->ry1) > 1.5) {
+        snprintf(msg, msz, "gen: rx/ry must be within 0.01..1.5"); return 0;
+    }
+    if (g->s0 > g->s1) { double t = g->s0; g->s0 = g->s1; g->s1 = t; }
+    if (g->s0 < 2 || g->s1 > 200) { snprintf(msg, msz, "gen: size must be within 2..200"); return 0; }
+
+    g->rmin = 1e9;
+    for (int i = 0; i < g->n; ++i) {
+        double f = g->n > 1 ? (double)i / (double)(g->n - 1) : 0.0;
+        g->rmin = fmin(g->rmin, fmax(g->rx0 + (g->rx1 - g->rx0) * f, g->ry0 + (g->ry1 - g->ry0) * f));
+    }
+    g->rng = g->seed ? g->seed : 1;
+    g->i = 0;
+    return 1;
+}
+
+void oi_gen_next(OiGen *g, double *rx, double *ry, double *w, int *size) {
+    double f = g->n > 1 ? (double)g->i / (double)(g->n - 1) : 0.0;
+    *rx = g->rx0 + (g->rx1 - g->rx0) * f;
+    *ry = g->ry0 + (g->ry1 - g->ry0) * f;
+    *w = g->kepler ? g->w0 * pow(fmax(*rx, *ry) / g->rmin, -1.5) : g->w0;
+    if (*w > 10.0) *w = 10.0;
+    if (*w < -10.0) *w = -10.0;
+    g->rng ^= g->rng << 13; g->rng ^= g->rng >> 17; g->rng ^= g->rng << 5;   /* xorshift32 */
+    *size = (int)g->s0 + (int)(g->rng % (unsigned)((int)g->s1 - (int)g->s0 + 1));
+    ++g->i;
+}
+
+static int spec_tokens(const char *spec, char tok[OI_SPEC_TOKENS][64], int len[OI_SPEC_TOKENS]) {
+    int nt = 0, used;
+    const char *p = spec;
+    while (nt < OI_SPEC_TOKENS && sscanf(p, "%63s%n", tok[nt], &used) == 1) {
+        p += used;
+        const char *eq = strchr(tok[nt], '=');
+        len[nt] = 1;
+        for (const char *c = eq ? eq + 1 : tok[nt]; *c; ++c) if (*c == ',') ++len[nt];
+        ++nt;
+    }
+    return nt;
+}
+
+long oi_spec_count(const char *spec) {
+    char tok[OI_SPEC_TOKENS][64];
+    int len[OI_SPEC_TOKENS];
+    int nt = spec_tokens(spec, tok, len);
+    long k = 1;
+    for (int t = 0; t < nt; ++t) {
+        k *= len[t];
+        if (k > OI_SPEC_MAX) return -1;
+    }
+    return k;
+}
+
+int oi_spec_expand(const char *spec, long i, char *cmd, size_t csz, char *label, size_t lsz) {
+    char tok[OI_SPEC_TOKENS][64];
+    int len[OI_SPEC_TOKENS];
+    int nt = spec_tokens(spec, tok, len);
+    long rest = i;
+    size_t cl = 0, ll = 0;
+    cmd[0] = '\0';
+    if (lsz) label[0] = '\0';
+    for (int t = 0; t < nt; ++t) {
+        char item[64];
+        if (len[t] == 1) {
+            snprintf(item, sizeof(item), "%s", tok[t]);
+        } else {
+            /* pick value rest % len of the list, keep the key */
+            int j = (int)(rest % len[t]);
+            rest /= len[t];
+            const char *eq = strchr(tok[t], '=');
+            const char *v = eq ? eq + 1 : tok[t];
+            while (j-- > 0) v = strchr(v, ',') + 1;
+            int vl = (int)strcspn(v, ",");
+            if (eq) snprintf(item, sizeof(item), "%.*s%.*s", (int)(eq - tok[t] + 1), tok[t], vl, v);
+            else snprintf(item, sizeof(item), "%.*s", vl, v);
+            ll += (size_t)snprintf(label + ll, ll < lsz ? lsz - ll : 0, "%s%s", ll ? " " : "", item);
+            if (ll >= lsz) ll = lsz ? lsz - 1 : 0;
+        }
+        cl += (size_t)snprintf(cmd + cl, cl < csz ? csz - cl : 0, "%s ", item);
+        if (cl >= csz) return 0;
+    }
+    return 1;
+}
+
+static int grid_generate(Grid *g, const char *cmd, char *msg, size_t msz) {
+    OiGen gen;
+    if (!oi_gen_parse(cmd, &gen, msg, msz)) return 0;
+    int N = gen.n;
+    if (!grid_reserve(g, N)) { snprintf(msg, msz, "gen: out of memory"); return 0; }
     for (int i = 0; i < N; ++i) {
-        const char *sry = g->cells[i*4 + 0].buf;
-        const char *srx = g->cells[i*4 + 1].buf;
-        const char *sw  = g->cells[i*4 + 2].buf;
-        const char *ss  = g->cells[i*4 + 3].buf;
-        char *end;
-        double ryr = strtod(sry, &end); if (end == sry) { snprintf(errmsg, emsz, "Ry invalid at %d", i+1); return 0; }
-        double rxr = strtod(srx, &end); if (end == srx) { snprintf(errmsg, emsz, "Rx invalid at %d", i+1); return 0; }
-        double omega = strtod(sw, &end); if (end == sw) { snprintf(errmsg, emsz, "Omega invalid at %d", i+1); return 0; }
-        long size = strtol(ss, &end, 10); if (end == ss) { snprintf(errmsg, emsz, "Size invalid at %d", i+1); return 0; }
-
-        if (!(ryr >= 0.01 && ryr <= 1.5)) { snprintf(errmsg, emsz, "Ry out of range at %d", i+1); return 0; }
-        if (!(rxr >= 0.01 && rxr <= 1.5)) { snprintf(errmsg, emsz, "Rx out of range at %d", i+1); return 0; }
-        if (!(omega >= -10.0 && omega <= 10.0)) { snprintf(errmsg, emsz, "Omega out of range at %d", i+1); return 0; }
-        if (!(size >= 2 && size <= 200)) { snprintf(errmsg, emsz, "Size out of range at %d", i+1); return 0; }
-
-        out[i].rx = rxr * baseRadius;
-        out[i].ry = ryr * baseRadius;
-        out[i].omega = omega * 0.5;
-        out[i].ang = (double)i * (2.0*M_PI / (double)N);
-        out[i].size = (int)size;
-        out[i].color = palette[i % PALETTE_COUNT];
+        double rx, ry, w;
+        int size;
+        oi_gen_next(&gen, &rx, &ry, &w, &size);
+        Cell *c = &g->cells[i * GRID_COLS];
+        snprintf(c[0].buf, CELL_BUFSZ, "%.4f", ry);
+        snprintf(c[1].buf, CELL_BUFSZ, "%.4f", rx);
+        snprintf(c[2].buf, CELL_BUFSZ, "%.4f", w);
+        snprintf(c[3].buf, CELL_BUFSZ, "%d", size);
+        snprintf(c[4].buf, CELL_BUFSZ, "0");
+        for (int k = 0; k < GRID_COLS; ++k) c[k].valid = 1;
     }
-    *outN = N; return 1;
+    g->N = N;
+    snprintf(msg, msz, "%d objetos gerados", N);
+    return N;
 }
 
 /* draw one cell */
@@ -338,416 +595,618 @@ static void draw_cell(SDL_Renderer *rnd, SDL_Rect rect, const char *buf, int foc
     SDL_Color border = focus ? (SDL_Color){255,200,80,255} : (SDL_Color){90,90,100,255};
     if (!valid) border = (SDL_Color){220,80,80,255};
     draw_panel(rnd, rect, bg, border);
-    draw_text_any(rnd, rect.x + 8, rect.y + 8, buf, (SDL_Color){230,230,230,255});
-}
-
-/* main modal */
-int oi_show_modal(SDL_Window *win, SDL_Renderer *rnd, Body out_bodies[], int *outN) {
-    Grid grid; grid.N = 0;
-    int use_defaults = 1;     /* toggle starts ON */
-    int chosenN = use_defaults ? 9 : 1;          /* when defaults on, use 9 by policy */
-    int focus = 0;            /* focused cell index */
-    int scroll = 0;           /* scroll offset (body index) */
-    int running = 1, res = -1;
-    int edit_started = 0;     /* indicates overwrite begun for focused cell */
-    int edit_index = -1;      /* which cell backup corresponds to */
-    char edit_backup[CELL_BUFSZ] = {0};
-
-    SDL_StartTextInput();
-    if (_saved_initialized) {
-        grid = _saved_grid;
-        use_defaults = _saved_use_defaults;
-        chosenN = _saved_chosenN;
-        focus = _saved_focus;
-        scroll = _saved_scroll;
+    draw_text_any(rnd, rect.x + 8, rect.y + (rect.h - 18) / 2, buf, (SDL_Color){230,230,230,255});
+}
+
+#define CMD_BUFSZ 128
+
+/* where the panel sits over the animation */
+enum { DOCK_RIGHT, DOCK_LEFT, DOCK_CENTER, DOCK_COUNT };
+
+/* widget geometry; depends only on the window size and the dock */
+typedef struct {
+    SDL_Rect modal, header, view, track;
+    SDL_Rect minus_btn, nbox, plus_btn;
+    SDL_Rect b_toggle, b_ok, b_cancel, cmd_box;
+    int padding, hint_y, hint_lines, msg_y;
+    int row_h, cell_h, num_w, cell_w;
+    int vis_rows;
+} Layout;
+
+/* Panel state, alive for the whole run. The grid is the source of truth for
+   the parameters; edits mark rows dirty and oi_panel_commit hands them to
+   the simulation. */
+typedef struct {
+    Grid grid;
+    int initialized;
+    int visible;
+    int dock;
+    int use_defaults;
+    int chosenN;
+    int focus;                 /* row*GRID_COLS + table column */
+    int scroll;                /* first visible row */
+    int edit_started;          /* overwrite begun for the focused cell */
+    int edit_index;            /* which cell edit_backup belongs to */
+    char edit_backup[CELL_BUFSZ];
+    int dragging_thumb, thumb_drag_offset;
+    int cmd_active;            /* generator command line has the keyboard */
+    char cmd[CMD_BUFSZ];
+    char errmsg[128];
+    int err_row;               /* row errmsg is about, -1 = not a row error */
+    char info[128];
+    int dirty_lo, dirty_hi;    /* rows edited since the last commit */
+    int committed_n;           /* rows the simulation has */
+    Layout layout;             /* recomputed only when the window size or dock changes */
+    int win_w, win_h;          /* window size in points the layout is for */
+    float scale_x, scale_y;    /* pixels per point (HiDPI: > 1) */
+} Modal;
+
+static Modal g_modal;
+
+/* w x h is the window in points. Docked, the panel is a full-height column
+   at one edge; centered, it is the old 840-wide modal. Either way it grows
+   in height with the window, so a tall window shows more rows. */
+static void modal_layout(Layout *L, int w, int h, int dock) {
+    int p = L->padding = 16;
+    SDL_Rect m;
+    if (dock == DOCK_CENTER) {
+        int mh = clampi(h - 60, 620, 1400);
+        m = (SDL_Rect){ (w - 840)/2, (h - mh)/2, 840, mh };
     } else {
-        grid_resize(&grid, chosenN);
+        int mw = 560;
+        m = (SDL_Rect){ dock == DOCK_LEFT ? 0 : w - mw, 0, mw, h };
     }
+    L->modal = m;
+    int wide = m.w >= 800;
+    int nbox_w = wide ? 160 : 110, btn_w = wide ? 160 : 110;
+
+    L->plus_btn  = (SDL_Rect){ m.x + m.w - p - 20 - 36, m.y + p + 28, 36, 32 };
+    L->nbox      = (SDL_Rect){ L->plus_btn.x - 8 - nbox_w, m.y + p + 24, nbox_w, 40 };
+    L->minus_btn = (SDL_Rect){ L->nbox.x - 8 - 36, m.y + p + 28, 36, 32 };
+
+    L->b_ok     = (SDL_Rect){ m.x + m.w - p - btn_w, m.y + m.h - p - 40, btn_w, 40 };
+    L->b_cancel = (SDL_Rect){ L->b_ok.x - 8 - btn_w, L->b_ok.y, btn_w, 40 };
+    L->b_toggle = (SDL_Rect){ m.x + p, L->b_ok.y, wide ? 132 : 84, 40 };
+    L->cmd_box  = (SDL_Rect){ m.x + p, L->b_ok.y - 8 - 30, m.w - 2*p, 30 };
+    L->msg_y    = L->cmd_box.y - 6 - 20;
+    L->hint_lines = wide ? 1 : 2;
+    L->hint_y   = L->msg_y - 4 - 20 * L->hint_lines;
+
+    L->row_h = 36;
+    L->cell_h = 30;
+    L->num_w = wide ? 64 : 52;
+    L->header = (SDL_Rect){ m.x + p, m.y + p + 84, m.w - 2*p - 20, 22 };
+    L->view = (SDL_Rect){ L->header.x, L->header.y + L->header.h + 4, L->header.w, 0 };
+    L->vis_rows = (L->hint_y - 8 - L->view.y) / L->row_h;
+    if (L->vis_rows < 1) L->vis_rows = 1;
+    L->view.h = L->vis_rows * L->row_h;
+    L->cell_w = (L->view.w - L->num_w - (GRID_COLS - 1) * 8) / GRID_COLS;
+    L->track = (SDL_Rect){ L->view.x + L->view.w + 6, L->view.y, 12, L->view.h };
+}
 
-    /* geometry */
-    SDL_Rect modal = { (WIN_W - 840)/2, (WIN_H - 620)/2, 840, 620 };
-    int padding = 16;
-    int header_h = 32;
-    int cell_h = 42;
-    int cell_w = (modal.w - padding*2 - 24) / 2;
-
-    /* fixed 2 objects per page */
-    int max_vis_bodies = 2;
-    int view_h = modal.h - padding*3 - 120;
-    int per_body_h = view_h / max_vis_bodies;
-    if (per_body_h < (2*cell_h + 60)) per_body_h = 2*cell_h + 60;
-
-    char errmsg[128] = {0};
-    SDL_Event ev;
-
-    int dragging_thumb = 0;
-    int thumb_drag_offset = 0;
-
-    while (running) {
-        int body_area_x = modal.x + padding;
-        int body_area_y = modal.y + padding + header_h + 24;
-        int body_area_h = modal.h - (padding*3 + 120);
-        int scroll_voffset = (cell_h / 2);
-        int view_h_adj = body_area_h - scroll_voffset;
-        if (view_h_adj < 0) view_h_adj = body_area_h;
-        SDL_Rect view = { body_area_x, body_area_y + scroll_voffset, modal.w - padding*2 - 8, view_h_adj };
-
-        int control_w = 36 + 8 + 160 + 8 + 36;
-        int right_col_right = body_area_x + 2 * cell_w + 12;
-        int ctrl_x = right_col_right - control_w;
-        int min_ctrl_x = modal.x + padding;
-        if (ctrl_x < min_ctrl_x) ctrl_x = min_ctrl_x;
-
-        int control_voff = scroll_voffset;
-
-        SDL_Rect minus_btn = { ctrl_x, modal.y + padding + 28 + control_voff, 36, 32 };
-        SDL_Rect nbox = { minus_btn.x + minus_btn.w + 8, modal.y + padding + 24 + control_voff, 160, 40 };
-        SDL_Rect plus_btn = { nbox.x + nbox.w + 8, modal.y + padding + 28 + control_voff, 36, 32 };
-
-        SDL_Rect b_toggle = { modal.x + padding, modal.y + modal.h - padding - 48, 220, 40 };
-        b_toggle.w = (int)round(b_toggle.w * 0.6);
-
-        SDL_Rect b_ok = { modal.x + modal.w - padding - 160, modal.y + modal.h - padding - 48, 160, 40 };
-        SDL_Rect b_cancel = { modal.x + modal.w - padding - 320, modal.y + modal.h - padding - 48, 160, 40 };
-        SDL_Rect track = { view.x + view.w + 8, view.y, 12, view.h };
-
-        int total_items = grid.N;
-        int visible_items = max_vis_bodies;
-        int thumb_h = 16;
-        int range_items = 0;
-        int thumb_y = track.y;
-        if (total_items > visible_items) {
-            thumb_h = (int)fmax(16.0, (double)track.h * (double)visible_items / (double)total_items);
-            range_items = total_items - visible_items;
-            if (range_items > 0) {
-                thumb_y = track.y + (int)round((double)(track.h - thumb_h) * ((double)scroll / (double)range_items));
-            } else {
-                thumb_y = track.y;
-            }
-        } else {
-            thumb_h = (int)fmax(16.0, (double)track.h);
-            thumb_y = track.y;
-        }
+/* cell rectangle of table column c on visible line v */
+static SDL_Rect cell_rect(const Layout *L, int v, int c) {
+    return (SDL_Rect){ L->view.x + L->num_w + c * (L->cell_w + 8),
+                       L->view.y + v * L->row_h + (L->row_h - L->cell_h) / 2, L->cell_w, L->cell_h };
+}
 
-        while (SDL_PollEvent(&ev)) {
-            if (ev.type == SDL_QUIT) { running = 0; res = -1; break; }
-
-            if (ev.type == SDL_KEYDOWN) {
-                if (ev.key.keysym.sym == SDLK_ESCAPE) {
-                    if (edit_started && edit_index == focus) {
-                        strncpy(grid.cells[focus].buf, edit_backup, CELL_BUFSZ);
-                        edit_started = 0; edit_index = -1;
-                    } else {
-                        running = 0; res = -1; break;
-                    }
-                    continue;
-                }
+static int in_rect(int x, int y, SDL_Rect r) {
+    return x >= r.x && x <= r.x + r.w && y >= r.y && y <= r.y + r.h;
+}
 
-                if (!use_defaults) {
-                    if (ev.key.keysym.sym == SDLK_PLUS || ev.key.keysym.sym == SDLK_KP_PLUS || ev.key.keysym.sym == SDLK_EQUALS) {
-                        chosenN = clampi(chosenN + 1, 1, ORBITAL_MAXOBJ);
-                        grid_resize(&grid, chosenN);
-                        if (grid.N > max_vis_bodies) scroll = chosenN - max_vis_bodies;
-                        continue;
-                    } else if (ev.key.keysym.sym == SDLK_MINUS || ev.key.keysym.sym == SDLK_KP_MINUS) {
-                        chosenN = clampi(chosenN - 1, 1, ORBITAL_MAXOBJ);
-                        grid_resize(&grid, chosenN);
-                        if (scroll > grid.N - max_vis_bodies) scroll = clampi(grid.N - max_vis_bodies, 0, grid.N);
-                        if (focus >= grid.N*4) focus = grid.N*4 - 1;
-                        continue;
-                    }
-
-                    if (ev.key.keysym.sym == SDLK_TAB && grid.N > 0) {
-                        int shift = (SDL_GetModState() & KMOD_SHIFT) != 0;
-                        int total = grid.N * 4;
-                        if (!shift) focus = (focus + 1) % total;
-                        else focus = (focus - 1 + total) % total;
-                        strncpy(edit_backup, grid.cells[focus].buf, CELL_BUFSZ);
-                        edit_index = focus; edit_started = 0;
-                        int bi = focus / 4;
-                        if (bi < scroll) scroll = bi;
-                        if (bi >= scroll + max_vis_bodies) scroll = bi - max_vis_bodies + 1;
-                        continue;
-                    } else if ((ev.key.keysym.sym == SDLK_RETURN || ev.key.keysym.sym == SDLK_KP_ENTER) && grid.N > 0) {
-                        focus = (focus + 1) % (grid.N*4);
-                        strncpy(edit_backup, grid.cells[focus].buf, CELL_BUFSZ);
-                        edit_index = focus; edit_started = 0;
-                        int bi = focus / 4;
-                        if (bi < scroll) scroll = bi;
-                        if (bi >= scroll + max_vis_bodies) scroll = bi - max_vis_bodies + 1;
-                        continue;
-                    } else if (ev.key.keysym.sym == SDLK_BACKSPACE && grid.N > 0) {
-                        char *b = grid.cells[focus].buf; size_t L = strlen(b);
-                        if (L) { b[L-1] = '\0'; edit_started = 1; }
-                        continue;
-                    } else if (ev.key.keysym.sym == SDLK_PAGEUP) {
-                        scroll = clampi(scroll - max_vis_bodies, 0, (grid.N > max_vis_bodies) ? (grid.N - max_vis_bodies) : 0);
-                        continue;
-                    } else if (ev.key.keysym.sym == SDLK_PAGEDOWN) {
-                        scroll = clampi(scroll + max_vis_bodies, 0, (grid.N > max_vis_bodies) ? (grid.N - max_vis_bodies) : 0);
-                        continue;
-                    } else if (ev.key.keysym.sym == SDLK_UP && grid.N > 0) {
-                        int c = focus % 4; int b = focus / 4;
-                        if (b > 0) { b--; focus = b*4 + c; if (b < scroll) scroll = b; }
-                        strncpy(edit_backup, grid.cells[focus].buf, CELL_BUFSZ); edit_index = focus; edit_started = 0;
-                        continue;
-                    } else if (ev.key.keysym.sym == SDLK_DOWN && grid.N > 0) {
-                        int c = focus % 4; int b = focus / 4;
-                        if (b < grid.N - 1) { b++; focus = b*4 + c; if (b >= scroll + max_vis_bodies) scroll = b - max_vis_bodies + 1; }
-                        strncpy(edit_backup, grid.cells[focus].buf, CELL_BUFSZ); edit_index = focus; edit_started = 0;
-                        continue;
-                    }
-                }
+static Cell* focus_cell(Modal *M) {
+    return &M->grid.cells[(M->focus / GRID_COLS) * GRID_COLS + col_cell[M->focus % GRID_COLS]];
+}
+
+static int max_scroll(const Modal *M, const Layout *L) {
+    return M->grid.N > L->vis_rows ? M->grid.N - L->vis_rows : 0;
+}
+
+static void show_row(Modal *M, const Layout *L, int row) {
+    if (row < M->scroll) M->scroll = row;
+    if (row >= M->scroll + L->vis_rows) M->scroll = row - L->vis_rows + 1;
+    M->scroll = clampi(M->scroll, 0, max_scroll(M, L));
+}
+
+/* rows [lo, hi) changed and must reach the simulation */
+static void mark_dirty(Modal *M, int lo, int hi) {
+    if (lo >= hi) return;
+    if (M->dirty_lo >= M->dirty_hi) { M->dirty_lo = lo; M->dirty_hi = hi; return; }
+    if (lo < M->dirty_lo) M->dirty_lo = lo;
+    if (hi > M->dirty_hi) M->dirty_hi = hi;
+}
+
+static void set_focus(Modal *M, const Layout *L, int f) {
+    int total = M->grid.N * GRID_COLS;
+    M->focus = clampi(f, 0, total - 1);
+    strncpy(M->edit_backup, focus_cell(M)->buf, CELL_BUFSZ);
+    M->edit_index = M->focus; M->edit_started = 0;
+    show_row(M, L, M->focus / GRID_COLS);
+}
+
+static void set_count(Modal *M, const Layout *L, int n) {
+    int oldN = M->grid.N;
+    M->chosenN = clampi(n, 1, ORBITAL_MAXOBJ);
+    grid_resize(&M->grid, M->chosenN);
+    M->chosenN = M->grid.N;
+    mark_dirty(M, oldN, M->grid.N);
+    if (M->focus >= M->grid.N * GRID_COLS) M->focus = M->grid.N * GRID_COLS - 1;
+    M->scroll = clampi(M->scroll, 0, max_scroll(M, L));
+    M->edit_started = 0; M->edit_index = -1;
+}
+
+static void thumb_geometry(const Modal *M, const Layout *L, int *thumb_y, int *thumb_h) {
+    int range = max_scroll(M, L);
+    *thumb_h = M->grid.N > 0 ? (int)fmax(16.0, (double)L->track.h * L->vis_rows / M->grid.N) : L->track.h;
+    if (*thumb_h > L->track.h) *thumb_h = L->track.h;
+    *thumb_y = L->track.y;
+    if (range > 0) *thumb_y += (int)round((double)(L->track.h - *thumb_h) * ((double)M->scroll / range));
+}
+
+static void modal_init(Modal *M) {
+    M->use_defaults = 1;       /* toggle starts ON */
+    M->chosenN = 9;            /* when defaults on, use 9 by policy */
+    M->focus = 0;
+    M->scroll = 0;
+    M->edit_index = -1;
+    M->err_row = -1;
+    M->visible = 1;
+    M->dock = DOCK_RIGHT;
+    grid_resize(&M->grid, M->chosenN);
+    mark_dirty(M, 0, M->grid.N);
+    M->initialized = 1;
+}
+
+static void manual_mode(Modal *M) {
+    M->use_defaults = 0;
+}
+
+static void run_command(Modal *M, const Layout *L) {
+    M->errmsg[0] = M->info[0] = '\0';
+    M->err_row = -1;
+    if (grid_generate(&M->grid, M->cmd, M->info, sizeof(M->info))) {
+        manual_mode(M);
+        M->chosenN = M->grid.N;
+        mark_dirty(M, 0, M->grid.N);
+        M->focus = 0; M->scroll = 0;
+        M->edit_started = 0; M->edit_index = -1;
+        M->cmd_active = 0;
+    } else {
+        snprintf(M->errmsg, sizeof(M->errmsg), "%s", M->info);
+        M->info[0] = '\0';
+    }
+    (void)L;
+}
+
+static void relayout(Modal *M) {
+    modal_layout(&M->layout, M->win_w, M->win_h, M->dock);
+    M->scroll = clampi(M->scroll, 0, max_scroll(M, &M->layout));
+}
+
+/* Returns 1 = event used by the panel, 0 = not for the panel, -1 = quit */
+static int modal_event(Modal *M, const Layout *L, const SDL_Event *ev) {
+    Grid *grid = &M->grid;
+
+    if (ev->type == SDL_KEYDOWN) {
+        SDL_Keycode key = ev->key.keysym.sym;
+        int ctrl = (SDL_GetModState() & KMOD_CTRL) != 0;
+
+        if (M->cmd_active) {
+            if (key == SDLK_ESCAPE) M->cmd_active = 0;
+            else if (key == SDLK_RETURN || key == SDLK_KP_ENTER) run_command(M, L);
+            else if (key == SDLK_BACKSPACE) { size_t n = strlen(M->cmd); if (n) M->cmd[n-1] = '\0'; }
+            return 1;
+        }
+        if (key == SDLK_ESCAPE) {
+            if (M->edit_started && M->edit_index == M->focus) {
+                strncpy(focus_cell(M)->buf, M->edit_backup, CELL_BUFSZ);
+                mark_dirty(M, M->focus / GRID_COLS, M->focus / GRID_COLS + 1);
+                M->edit_started = 0; M->edit_index = -1;
+                return 1;
             }
-            else if (ev.type == SDL_TEXTINPUT && grid.N > 0) {
-                if (use_defaults) continue;
-                if (edit_index != focus) {
-                    strncpy(edit_backup, grid.cells[focus].buf, CELL_BUFSZ);
-                    edit_index = focus; edit_started = 0;
-                }
-                if (!edit_started) {
-                    grid.cells[focus].buf[0] = '\0';
-                    edit_started = 1;
-                }
-                const char *text = ev.text.text;
-                for (int k = 0; text[k]; ++k) {
-                    char ch = text[k];
-                    if ((ch >= '0' && ch <= '9') || ch == '.' || ch == '-') {
-                        char *b = grid.cells[focus].buf;
-                        if (strlen(b) + 1 < CELL_BUFSZ) { size_t L = strlen(b); b[L] = ch; b[L+1] = '\0'; }
-                    }
-                }
-                continue;
+            oi_panel_set_visible(0);
+            return 1;
+        }
+        if (ctrl && key == SDLK_d) {
+            M->dock = (M->dock + 1) % DOCK_COUNT;
+            relayout(M);
+            return 1;
+        }
+        if (ctrl && key == SDLK_g) {
+            M->cmd_active = 1;
+            if (!M->cmd[0]) snprintf(M->cmd, sizeof(M->cmd), "gen 1000 rx=0.1:1.4 ry=0.08:1.2 w=1 kepler size=6:20");
+            return 1;
+        }
+        if (ctrl && key == SDLK_c) {
+            char *s = grid_copy_text(grid);
+            if (s) {
+                SDL_SetClipboardText(s);
+                snprintf(M->info, sizeof(M->info), "%d linhas copiadas", grid->N);
+                free(s);
             }
-            else if (ev.type == SDL_MOUSEWHEEL && grid.N > 0) {
-                if (ev.wheel.y > 0) scroll = (scroll > 0) ? scroll - 1 : 0;
-                else { if (grid.N > max_vis_bodies) { int max = grid.N - max_vis_bodies; scroll = (scroll < max) ? scroll + 1 : max; } }
-                continue;
+            return 1;
+        }
+        if (ctrl && key == SDLK_v) {
+            char *s = SDL_HasClipboardText() ? SDL_GetClipboardText() : NULL;
+            int row = M->use_defaults ? 0 : M->focus / GRID_COLS;
+            int n = s ? grid_paste(grid, row, s) : 0;
+            if (s) SDL_free(s);
+            M->errmsg[0] = '\0';
+            M->err_row = -1;
+            if (n > 0) {
+                manual_mode(M);
+                M->chosenN = grid->N;
+                mark_dirty(M, row, row + n);
+                M->edit_started = 0; M->edit_index = -1;
+                show_row(M, L, row);
+                snprintf(M->info, sizeof(M->info), "%d linhas coladas", n);
+            } else {
+                snprintf(M->errmsg, sizeof(M->errmsg), "Nada para colar (Rx Ry w size [pai] por linha)");
             }
-            else if (ev.type == SDL_MOUSEBUTTONDOWN) {
-                int mx = ev.button.x, my = ev.button.y;
-
-                if (grid.N > max_vis_bodies) {
-                    SDL_Rect thumb_rect = { track.x + 2, thumb_y, track.w - 4, thumb_h };
-                    if (mx >= thumb_rect.x && mx <= thumb_rect.x + thumb_rect.w &&
-                        my >= thumb_rect.y && my <= thumb_rect.y + thumb_rect.h) {
-                        dragging_thumb = 1;
-                        thumb_drag_offset = my - thumb_rect.y;
-                        continue;
-                    }
-                }
-
-                if (!use_defaults) {
-                    if (mx >= plus_btn.x && mx <= plus_btn.x + plus_btn.w && my >= plus_btn.y && my <= plus_btn.y + plus_btn.h) {
-                        chosenN = clampi(chosenN + 1, 1, ORBITAL_MAXOBJ);
-                        grid_resize(&grid, chosenN);
-                        if (grid.N > max_vis_bodies) scroll = chosenN - max_vis_bodies;
-                        edit_started = 0; edit_index = -1;
-                        continue;
-                    } else if (mx >= minus_btn.x && mx <= minus_btn.x + minus_btn.w && my >= minus_btn.y && my <= minus_btn.y + minus_btn.h) {
-                        chosenN = clampi(chosenN - 1, 1, ORBITAL_MAXOBJ);
-                        grid_resize(&grid, chosenN);
-                        if (scroll > grid.N - max_vis_bodies) scroll = clampi(grid.N - max_vis_bodies, 0, grid.N);
-                        if (focus >= grid.N*4) focus = grid.N*4 - 1;
-                        edit_started = 0; edit_index = -1;
-                        continue;
-                    }
-                }
-
-                /* click in view: visual left now shows Rx, visual right shows Ry */
-                if (!use_defaults && mx >= view.x && mx <= view.x + view.w && my >= view.y && my <= view.y + view.h && grid.N > 0) {
-                    int relY = my - body_area_y;
-                    int vis_idx = relY / per_body_h;
-                    if (vis_idx >= 0 && vis_idx < max_vis_bodies) {
-                        int bi = scroll + vis_idx;
-                        if (bi >= 0 && bi < grid.N) {
-                            int by = body_area_y + vis_idx * per_body_h;
-                            SDL_Rect leftRect  = { body_area_x, by + 52, cell_w, cell_h };                    /* visually left = Rx */
-                            SDL_Rect rightRect = { body_area_x + cell_w + 12, by + 52, cell_w, cell_h };       /* visually right = Ry */
-                            SDL_Rect wrect = { body_area_x, by + 52 + cell_h + 10 + 24, cell_w, cell_h };
-                            SDL_Rect srect = { body_area_x + cell_w + 12, by + 52 + cell_h + 10 + 24, cell_w, cell_h };
-                            if (mx >= leftRect.x && mx <= leftRect.x + leftRect.w && my >= leftRect.y && my <= leftRect.y + leftRect.h) {
-                                focus = bi*4 + 1; /* left -> Rx stored at cell index 1 */
-                            } else if (mx >= rightRect.x && mx <= rightRect.x + rightRect.w && my >= rightRect.y && my <= rightRect.y + rightRect.h) {
-                                focus = bi*4 + 0; /* right -> Ry stored at cell index 0 */
-                            } else if (mx >= wrect.x && mx <= wrect.x + wrect.w && my >= wrect.y && my <= wrect.y + wrect.h) {
-                                focus = bi*4 + 2;
-                            } else if (mx >= srect.x && mx <= srect.x + srect.w && my >= srect.y && my <= srect.y + srect.h) {
-                                focus = bi*4 + 3;
-                            }
-                            strncpy(edit_backup, grid.cells[focus].buf, CELL_BUFSZ);
-                            edit_index = focus; edit_started = 0;
-                        }
-                    }
-                    continue;
-                }
+            return 1;
+        }
 
-                if (mx >= b_toggle.x && mx <= b_toggle.x + b_toggle.w && my >= b_toggle.y && my <= b_toggle.y + b_toggle.h) {
-                    use_defaults = !use_defaults;
-                    if (use_defaults) { chosenN = 9; grid_fill_defaults(&grid, chosenN); scroll = 0; focus = 0; }
-                    else { grid_resize(&grid, chosenN); scroll = 0; }
-                    edit_started = 0; edit_index = -1;
-                    continue;
-                }
-                if (mx >= b_ok.x && mx <= b_ok.x + b_ok.w && my >= b_ok.y && my <= b_ok.y + b_ok.h) {
-                    if (use_defaults) {
-                        chosenN = 9;
-                        grid_fill_defaults(&grid, chosenN);
-                        scroll = 0; focus = 0;
-                    }
-                    if (grid_to_bodies(&grid, out_bodies, outN, errmsg, sizeof(errmsg))) { res = 1; running = 0; break; }
-                    else {
-                        int idx = 0; sscanf(errmsg, "%*s %*s %*s %d", &idx);
-                        if (idx >= 1 && idx <= grid.N) {
-                            for (int k = 0; k < 4; ++k) grid.cells[(idx-1)*4 + k].valid = 0;
-                            focus = (idx-1)*4;
-                            if ((idx-1) < scroll) scroll = idx-1;
-                            if ((idx-1) >= scroll + max_vis_bodies) scroll = idx-1 - max_vis_bodies + 1;
-                        }
-                    }
-                    continue;
-                }
-                if (mx >= b_cancel.x && mx <= b_cancel.x + b_cancel.w && my >= b_cancel.y && my <= b_cancel.y + b_cancel.h) {
-                    res = -1; running = 0; break;
-                }
-                if (grid.N > max_vis_bodies && mx >= track.x && mx <= track.x + track.w && my >= track.y && my <= track.y + track.h) {
-                    int total = grid.N; int visible = max_vis_bodies;
-                    int thumb_h_local = thumb_h;
-                    int range = total - visible;
-                    int thumb_y_local = thumb_y;
-                    if (range > 0) thumb_y_local = track.y + (int)round((double)(track.h - thumb_h_local) * ((double)scroll / (double)range));
-                    if (my < thumb_y_local) scroll = clampi(scroll - visible, 0, range);
-                    else if (my > thumb_y_local + thumb_h_local) scroll = clampi(scroll + visible, 0, range);
-                    continue;
-                }
+        if (M->use_defaults) return 1;
+        int total = grid->N * GRID_COLS;
+        int row = M->focus / GRID_COLS, col = M->focus % GRID_COLS;
+        switch (key) {
+            case SDLK_PLUS: case SDLK_KP_PLUS: case SDLK_EQUALS:
+                set_count(M, L, M->chosenN + 1);
+                show_row(M, L, grid->N - 1);
+                break;
+            case SDLK_MINUS: case SDLK_KP_MINUS:
+                set_count(M, L, M->chosenN - 1);
+                break;
+            case SDLK_TAB:
+                if (SDL_GetModState() & KMOD_SHIFT) set_focus(M, L, (M->focus - 1 + total) % total);
+                else set_focus(M, L, (M->focus + 1) % total);
+                break;
+            case SDLK_RETURN: case SDLK_KP_ENTER:
+                set_focus(M, L, (M->focus + 1) % total);
+                break;
+            case SDLK_BACKSPACE: {
+                char *b = focus_cell(M)->buf; size_t n = strlen(b);
+                if (n) { b[n-1] = '\0'; M->edit_started = 1; mark_dirty(M, row, row + 1); }
+                break;
             }
-            else if (ev.type == SDL_MOUSEMOTION) {
-                if (dragging_thumb && grid.N > max_vis_bodies) {
-                    int my = ev.motion.y;
-                    int rel = my - track.y - thumb_drag_offset;
-                    int track_range = track.h - thumb_h;
-                    if (track_range < 1) track_range = 1;
-                    if (rel < 0) rel = 0;
-                    if (rel > track_range) rel = track_range;
-                    int range_items_local = grid.N - max_vis_bodies;
-                    double frac = (double)rel / (double)track_range;
-                    int new_scroll = (int)round(frac * (double)range_items_local);
-                    scroll = clampi(new_scroll, 0, range_items_local);
-                }
+            case SDLK_PAGEUP:   M->scroll = clampi(M->scroll - L->vis_rows, 0, max_scroll(M, L)); break;
+            case SDLK_PAGEDOWN: M->scroll = clampi(M->scroll + L->vis_rows, 0, max_scroll(M, L)); break;
+            case SDLK_HOME:     set_focus(M, L, col); break;
+            case SDLK_END:      set_focus(M, L, (grid->N - 1) * GRID_COLS + col); break;
+            case SDLK_UP:       if (row > 0) set_focus(M, L, M->focus - GRID_COLS); break;
+            case SDLK_DOWN:     if (row < grid->N - 1) set_focus(M, L, M->focus + GRID_COLS); break;
+            default: break;
+        }
+        return 1;
+    }
+    if (ev->type == SDL_TEXTINPUT) {
+        const char *text = ev->text.text;
+        if (M->cmd_active) {
+            size_t n = strlen(M->cmd);
+            for (int k = 0; text[k] && n + 1 < CMD_BUFSZ; ++k) M->cmd[n++] = text[k];
+            M->cmd[n] = '\0';
+            return 1;
+        }
+        if (M->use_defaults || grid->N == 0) return 1;
+        Cell *c = focus_cell(M);
+        if (M->edit_index != M->focus) {
+            strncpy(M->edit_backup, c->buf, CELL_BUFSZ);
+            M->edit_index = M->focus; M->edit_started = 0;
+        }
+        if (!M->edit_started) { c->buf[0] = '\0'; M->edit_started = 1; }
+        for (int k = 0; text[k]; ++k) {
+            char ch = text[k];
+            if ((ch >= '0' && ch <= '9') || ch == '.' || ch == '-') {
+                size_t n = strlen(c->buf);
+                if (n + 1 < CELL_BUFSZ) { c->buf[n] = ch; c->buf[n+1] = '\0'; }
             }
-            else if (ev.type == SDL_MOUSEBUTTONUP) {
-                if (dragging_thumb) { dragging_thumb = 0; }
+        }
+        mark_dirty(M, M->focus / GRID_COLS, M->focus / GRID_COLS + 1);
+        return 1;
+    }
+    if (ev->type == SDL_MOUSEWHEEL) {
+        int mx, my;
+        SDL_GetMouseState(&mx, &my);
+        if (!in_rect(mx, my, L->modal)) return 0;
+        M->scroll = clampi(M->scroll - 3 * ev->wheel.y, 0, max_scroll(M, L));
+        return 1;
+    }
+    if (ev->type == SDL_MOUSEBUTTONDOWN) {
+        int mx = ev->button.x, my = ev->button.y;
+        if (!in_rect(mx, my, L->modal)) { M->cmd_active = 0; return 0; }
+        int thumb_y, thumb_h;
+        thumb_geometry(M, L, &thumb_y, &thumb_h);
+
+        if (max_scroll(M, L) > 0 && in_rect(mx, my, L->track)) {
+            if (my >= thumb_y && my <= thumb_y + thumb_h) {
+                M->dragging_thumb = 1;
+                M->thumb_drag_offset = my - thumb_y;
+            } else if (my < thumb_y) {
+                M->scroll = clampi(M->scroll - L->vis_rows, 0, max_scroll(M, L));
+            } else {
+                M->scroll = clampi(M->scroll + L->vis_rows, 0, max_scroll(M, L));
+            }
+            return 1;
+        }
+        if (in_rect(mx, my, L->cmd_box)) {
+            M->cmd_active = 1;
+            return 1;
+        }
+        M->cmd_active = 0;
+        if (!M->use_defaults) {
+            if (in_rect(mx, my, L->plus_btn)) { set_count(M, L, M->chosenN + 1); show_row(M, L, grid->N - 1); return 1; }
+            if (in_rect(mx, my, L->minus_btn)) { set_count(M, L, M->chosenN - 1); return 1; }
+            /* the row and column under the pointer come straight from the geometry */
+            if (in_rect(mx, my, L->view)) {
+                int v = (my - L->view.y) / L->row_h;
+                int row = M->scroll + v;
+                if (row < grid->N) {
+                    for (int c = 0; c < GRID_COLS; ++c)
+                        if (in_rect(mx, my, cell_rect(L, v, c))) { set_focus(M, L, row * GRID_COLS + c); break; }
+                }
+                return 1;
             }
-        } /* event loop */
-
-        /* render */
-        SDL_SetRenderDrawBlendMode(rnd, SDL_BLENDMODE_BLEND);
-        SDL_SetRenderDrawColor(rnd, 0,0,0,160); SDL_RenderFillRect(rnd, NULL);
-        draw_panel(rnd, modal, (SDL_Color){18,18,22,240}, (SDL_Color){110,110,130,255});
-
-        draw_title(rnd, modal.x + padding, modal.y + padding, "PARÂMETROS DE ENTRADA", (SDL_Color){200,220,255,255});
-
-        if (!use_defaults) draw_text_any(rnd, modal.x + padding, modal.y + padding + 42, "Edição manual ativa", (SDL_Color){200,200,200,255});
-        else draw_text_any(rnd, modal.x + padding, modal.y + padding + 42, "Usando defaults (desative toggle para editar)", (SDL_Color){180,180,180,255});
-
-        /* draw control group inside panel */
-        draw_panel(rnd, minus_btn, (SDL_Color){50,50,60,255}, (SDL_Color){100,100,120,255});
-        draw_panel(rnd, nbox, (SDL_Color){36,36,46,255}, (SDL_Color){100,100,120,255});
-        draw_panel(rnd, plus_btn, (SDL_Color){50,50,60,255}, (SDL_Color){100,100,120,255});
-        char nbuf[16]; snprintf(nbuf, sizeof(nbuf), "%d", chosenN);
-        draw_text_center_any(rnd, nbox, nbuf, (SDL_Color){230,230,230,255});
-        SDL_Color ctrlcol = use_defaults ? (SDL_Color){120,120,120,255} : (SDL_Color){220,220,220,255};
-        draw_text_any(rnd, minus_btn.x + 10, minus_btn.y + 8, "-", ctrlcol);
-        draw_text_any(rnd, plus_btn.x + 10, plus_btn.y + 8, "+", ctrlcol);
-
-        /* draw view */
-        SDL_RenderSetClipRect(rnd, &view);
-        for (int bi = 0; bi < grid.N; ++bi) {
-            int vis = bi - scroll; if (vis < 0 || vis >= max_vis_bodies) continue;
-            int by = body_area_y + vis * per_body_h + (vis == 0 ? (cell_h / 2) : 0);
-
-            char title[64]; snprintf(title, sizeof(title), "Objeto %d", bi+1);
-            draw_text_any(rnd, body_area_x + 2, by, title, (SDL_Color){200,220,255,255});
-
-            /* VISUAL: display Rx left and Ry right */
-            draw_text_any(rnd, body_area_x + 2, by + 22, "SEMI-EIXOS (Rx esquerda ; Ry direita)", (SDL_Color){200,200,200,255});
-            SDL_Rect leftRect  = { body_area_x, by + 52, cell_w, cell_h };
-            SDL_Rect rightRect = { body_area_x + cell_w + 12, by + 52, cell_w, cell_h };
-            int fi = bi*4;
-            draw_cell(rnd, leftRect,  grid.cells[fi+1].buf, focus==fi+1, grid.cells[fi+1].valid); /* show Rx */
-            draw_cell(rnd, rightRect, grid.cells[fi+0].buf, focus==fi+0, grid.cells[fi+0].valid); /* show Ry */
-
-            draw_text_any(rnd, body_area_x + 2, by + 52 + cell_h + 10, "VELOCIDADE ANGULAR E TAMANHO", (SDL_Color){200,200,200,255});
-            SDL_Rect wrect = { body_area_x, by + 52 + cell_h + 10 + 24, cell_w, cell_h };
-            SDL_Rect srect = { body_area_x + cell_w + 12, by + 52 + cell_h + 10 + 24, cell_w, cell_h };
-            draw_cell(rnd, wrect, grid.cells[fi+2].buf, focus==fi+2, grid.cells[fi+2].valid);
-            draw_cell(rnd, srect, grid.cells[fi+3].buf, focus==fi+3, grid.cells[fi+3].valid);
         }
-        SDL_RenderSetClipRect(rnd, NULL);
-
-        /* scrollbar (visual) */
-        if (grid.N > max_vis_bodies) {
-            draw_panel(rnd, track, (SDL_Color){40,40,40,200}, (SDL_Color){90,90,90,200});
-            int total = grid.N; int visible = max_vis_bodies;
-            int thumb_h_now = (int)fmax(16.0, (double)track.h * (double)visible / (double)total);
-            int range = total - visible;
-            int thumb_y_now = track.y;
-            if (range > 0) thumb_y_now = track.y + (int)round((double)(track.h - thumb_h_now) * ((double)scroll / (double)range));
-            SDL_Rect thumb = { track.x + 2, thumb_y_now, track.w - 4, thumb_h_now };
-            draw_panel(rnd, thumb, (SDL_Color){120,120,120,220}, (SDL_Color){200,200,200,220});
+        if (in_rect(mx, my, L->b_toggle)) {
+            int oldN = grid->N;
+            M->use_defaults = !M->use_defaults;
+            if (M->use_defaults) { M->chosenN = 9; grid_fill_defaults(grid, M->chosenN); M->focus = 0; }
+            else grid_resize(grid, M->chosenN);
+            mark_dirty(M, 0, oldN > grid->N ? oldN : grid->N);
+            M->scroll = 0;
+            M->edit_started = 0; M->edit_index = -1;
+            return 1;
         }
+        if (in_rect(mx, my, L->b_ok)) { oi_panel_set_visible(0); return 1; }
+        if (in_rect(mx, my, L->b_cancel)) return -1;
+        return 1;
+    }
+    if (ev->type == SDL_MOUSEMOTION && M->dragging_thumb) {
+        int thumb_y, thumb_h;
+        thumb_geometry(M, L, &thumb_y, &thumb_h);
+        int track_range = L->track.h - thumb_h;
+        if (track_range < 1) track_range = 1;
+        int rel = clampi(ev->motion.y - L->track.y - M->thumb_drag_offset, 0, track_range);
+        M->scroll = clampi((int)round((double)rel / track_range * max_scroll(M, L)), 0, max_scroll(M, L));
+        return 1;
+    }
+    if (ev->type == SDL_MOUSEBUTTONUP && M->dragging_thumb) { M->dragging_thumb = 0; return 1; }
+    return 0;
+}
 
-        /* bottom hints and controls */
-        draw_text_any(rnd, modal.x + padding, modal.y + modal.h - padding - 88, "Tab/Shift+Tab mover  Clique para foco  Enter proximo  Esc cancelar", (SDL_Color){180,180,180,255});
-
-        /* Modern rounded toggle UI */
-        {
-            SDL_Color btn_bg = (SDL_Color){50,50,60,255};
-            SDL_Color btn_border = (SDL_Color){100,100,120,255};
-            SDL_Color knob_on_color = (SDL_Color){40,80,40,255};
-            SDL_Color knob_off_color = (SDL_Color){200,220,255,255};
-
-            SDL_Rect tbg = b_toggle;
-            int radius = tbg.h / 2;
-
-            fill_rounded_rect(rnd, tbg, radius, btn_bg);
-            draw_rounded_rect_border(rnd, tbg, radius, btn_border);
-
-            int krad = radius - 3; if (krad < 4) krad = radius - 2;
-            int pad = 3;
-            int left_x  = tbg.x + pad + krad;
-            int right_x = tbg.x + tbg.w - pad - krad;
-            int ky = tbg.y + tbg.h/2;
-            int kx = use_defaults ? right_x : left_x;
-            SDL_Color knob_col = use_defaults ? knob_on_color : knob_off_color;
-            SDL_Color shadow = (SDL_Color){20,20,20,120};
-            fill_circle(rnd, kx, ky + 1, krad + 1, shadow);
-            fill_circle(rnd, kx, ky, krad, knob_col);
-
-            draw_text_any(rnd, tbg.x + tbg.w + 12, tbg.y + (tbg.h - 16)/2, "Use defaults", (SDL_Color){220,220,220,255});
+/* Draws only the rows inside the view: cost depends on the view height,
+   not on the number of objects. */
+static void modal_render(SDL_Renderer *rnd, const Modal *M, const Layout *L) {
+    const Grid *grid = &M->grid;
+    SDL_Rect modal = L->modal;
+    int padding = L->padding;
+
+    SDL_SetRenderDrawBlendMode(rnd, SDL_BLENDMODE_BLEND);
+    draw_panel(rnd, modal, (SDL_Color){18,18,22,215}, (SDL_Color){110,110,130,255});
+
+    draw_title(rnd, modal.x + padding, modal.y + padding, "PARÂMETROS DE ENTRADA", (SDL_Color){200,220,255,255});
+
+    if (!M->use_defaults) draw_text_any(rnd, modal.x + padding, modal.y + padding + 42, "Edição manual ativa", (SDL_Color){200,200,200,255});
+    else draw_text_any(rnd, modal.x + padding, modal.y + padding + 42, "Usando defaults (desative toggle para editar)", (SDL_Color){180,180,180,255});
+
+    /* draw control group inside panel */
+    draw_panel(rnd, L->minus_btn, (SDL_Color){50,50,60,255}, (SDL_Color){100,100,120,255});
+    draw_panel(rnd, L->nbox, (SDL_Color){36,36,46,255}, (SDL_Color){100,100,120,255});
+    draw_panel(rnd, L->plus_btn, (SDL_Color){50,50,60,255}, (SDL_Color){100,100,120,255});
+    char nbuf[16]; snprintf(nbuf, sizeof(nbuf), "%d", M->chosenN);
+    draw_text_center_any(rnd, L->nbox, nbuf, (SDL_Color){230,230,230,255});
+    SDL_Color ctrlcol = M->use_defaults ? (SDL_Color){120,120,120,255} : (SDL_Color){220,220,220,255};
+    draw_text_any(rnd, L->minus_btn.x + 10, L->minus_btn.y + 8, "-", ctrlcol);
+    draw_text_any(rnd, L->plus_btn.x + 10, L->plus_btn.y + 8, "+", ctrlcol);
+
+    /* column titles (visual left shows Rx, right of it Ry) */
+    SDL_Color head = {200,220,255,255};
+    draw_text_any(rnd, L->header.x + 2, L->header.y, "Obj", head);
+    for (int c = 0; c < GRID_COLS; ++c)
+        draw_text_any(rnd, cell_rect(L, 0, c).x + 2, L->header.y, col_title[c], head);
+
+    SDL_RenderSetClipRect(rnd, &L->view);
+    int last = M->scroll + L->vis_rows;
+    if (last > grid->N) last = grid->N;
+    for (int row = M->scroll; row < last; ++row) {
+        int v = row - M->scroll;
+        char num[16]; snprintf(num, sizeof(num), "%d", row + 1);
+        draw_text_any(rnd, L->view.x + 2, L->view.y + v * L->row_h + (L->row_h - 18) / 2, num, (SDL_Color){200,220,255,255});
+        const Cell *cells = &grid->cells[row * GRID_COLS];
+        for (int c = 0; c < GRID_COLS; ++c) {
+            const Cell *cl = &cells[col_cell[c]];
+            draw_cell(rnd, cell_rect(L, v, c), cl->buf, M->focus == row * GRID_COLS + c, cl->valid);
         }
+    }
+    SDL_RenderSetClipRect(rnd, NULL);
+
+    /* scrollbar */
+    if (max_scroll(M, L) > 0) {
+        int thumb_y, thumb_h;
+        thumb_geometry(M, L, &thumb_y, &thumb_h);
+        draw_panel(rnd, L->track, (SDL_Color){40,40,40,200}, (SDL_Color){90,90,90,200});
+        SDL_Rect thumb = { L->track.x + 2, thumb_y, L->track.w - 4, thumb_h };
+        draw_panel(rnd, thumb, (SDL_Color){120,120,120,220}, (SDL_Color){200,200,200,220});
+    }
+
+    /* bottom hints, status, generator line and controls */
+    SDL_Color hint = {180,180,180,255};
+    if (L->hint_lines == 1) {
+        draw_text_any(rnd, modal.x + padding, L->hint_y, "Tab mover  Ctrl+V colar  Ctrl+C copiar  Ctrl+G gerador  Ctrl+D dock  Esc ocultar", hint);
+    } else {
+        draw_text_any(rnd, modal.x + padding, L->hint_y, "Tab mover  Ctrl+V colar  Ctrl+C copiar", hint);
+        draw_text_any(rnd, modal.x + padding, L->hint_y + 20, "Ctrl+G gerador  Ctrl+D dock  Esc ocultar", hint);
+    }
+    if (M->errmsg[0]) draw_text_any(rnd, modal.x + padding, L->msg_y, M->errmsg, (SDL_Color){255,120,120,255});
+    else if (M->info[0]) draw_text_any(rnd, modal.x + padding, L->msg_y, M->info, (SDL_Color){160,220,160,255});
+
+    draw_panel(rnd, L->cmd_box, (SDL_Color){28,28,36,230}, M->cmd_active ? (SDL_Color){255,200,80,255} : (SDL_Color){90,90,100,255});
+    if (M->cmd_active || M->cmd[0]) {
+        char line[CMD_BUFSZ + 8]; snprintf(line, sizeof(line), "> %s%s", M->cmd, M->cmd_active ? "_" : "");
+        draw_text_any(rnd, L->cmd_box.x + 8, L->cmd_box.y + (L->cmd_box.h - 18) / 2, line, (SDL_Color){230,230,230,255});
+    } else {
+        draw_text_any(rnd, L->cmd_box.x + 8, L->cmd_box.y + (L->cmd_box.h - 18) / 2,
+                      "gen N rx=a:b ry=a:b w=w0 kepler size=a:b seed=s", (SDL_Color){120,120,130,255});
+    }
 
-        draw_panel(rnd, b_cancel, (SDL_Color){80,40,40,255}, (SDL_Color){160,100,100,255});
-        draw_panel(rnd, b_ok, (SDL_Color){40,80,40,255}, (SDL_Color){120,200,120,255});
-        draw_text_center_any(rnd, b_cancel, "CANCEL", (SDL_Color){255,220,220,255});
-        draw_text_center_any(rnd, b_ok, "OK", (SDL_Color){220,255,220,255});
+    /* Modern rounded toggle UI */
+    {
+        SDL_Color btn_bg = (SDL_Color){50,50,60,255};
+        SDL_Color btn_border = (SDL_Color){100,100,120,255};
+        SDL_Color knob_on_color = (SDL_Color){40,80,40,255};
+        SDL_Color knob_off_color = (SDL_Color){200,220,255,255};
+
+        SDL_Rect tbg = L->b_toggle;
+        int radius = tbg.h / 2;
+
+        fill_rounded_rect(rnd, tbg, radius, btn_bg);
+        draw_rounded_rect_border(rnd, tbg, radius, btn_border);
+
+        int krad = radius - 3; if (krad < 4) krad = radius - 2;
+        int pad = 3;
+        int left_x  = tbg.x + pad + krad;
+        int right_x = tbg.x + tbg.w - pad - krad;
+        int ky = tbg.y + tbg.h/2;
+        int kx = M->use_defaults ? right_x : left_x;
+        SDL_Color knob_col = M->use_defaults ? knob_on_color : knob_off_color;
+        SDL_Color shadow = (SDL_Color){20,20,20,120};
+        fill_circle(rnd, kx, ky + 1, krad + 1, shadow);
+        fill_circle(rnd, kx, ky, krad, knob_col);
+
+        draw_text_any(rnd, tbg.x + tbg.w + 12, tbg.y + (tbg.h - 16)/2, "Defaults", (SDL_Color){220,220,220,255});
+    }
 
-        if (errmsg[0]) draw_text_any(rnd, modal.x + padding + 240, modal.y + modal.h - padding - 48, errmsg, (SDL_Color){255,120,120,255});
+    draw_panel(rnd, L->b_cancel, (SDL_Color){80,40,40,255}, (SDL_Color){160,100,100,255});
+    draw_panel(rnd, L->b_ok, (SDL_Color){40,80,40,255}, (SDL_Color){120,200,120,255});
+    draw_text_center_any(rnd, L->b_cancel, "SAIR", (SDL_Color){255,220,220,255});
+    draw_text_center_any(rnd, L->b_ok, "OCULTAR", (SDL_Color){220,255,220,255});
+}
 
-        SDL_RenderPresent(rnd);
-        SDL_Delay(12);
-    } /* loop */
+/* Match the window: the panel is laid out in points and drawn with the
+   renderer scaled to the pixel density; the layout is redone only if the
+   size changed. */
+static void modal_resize(Modal *M, SDL_Window *win, SDL_Renderer *rnd) {
+    int w, h, pw, ph;
+    SDL_GetWindowSize(win, &w, &h);
+    if (SDL_GetRendererOutputSize(rnd, &pw, &ph) != 0 || pw <= 0 || ph <= 0) { pw = w; ph = h; }
+    M->scale_x = (float)pw / (float)w;
+    M->scale_y = (float)ph / (float)h;
+    if (w == M->win_w && h == M->win_h) return;
+    M->win_w = w; M->win_h = h;
+    relayout(M);
+}
 
-    _saved_grid = grid;
-    _saved_use_defaults = use_defaults;
-    _saved_chosenN = chosenN;
-    _saved_focus = focus;
-    _saved_scroll = scroll;
-    _saved_initialized = 1;
+static Modal* panel(SDL_Window *win, SDL_Renderer *rnd) {
+    Modal *M = &g_modal;
+    if (!M->initialized) modal_init(M);
+    if (!M->win_w) modal_resize(M, win, rnd);
+    return M;
+}
 
-    SDL_StopTextInput();
-    if (g_font) { TTF_CloseFont(g_font); g_font = NULL; }
-    if (g_font_title) { TTF_CloseFont(g_font_title); g_font_title = NULL; }
-    if (ttf_inited) { TTF_Quit(); ttf_inited = 0; }
-    return res;
-}
\ No newline at end of file
+void oi_panel_set_visible(int visible) {
+    Modal *M = &g_modal;
+    if (!M->initialized) modal_init(M);
+    M->visible = visible;
+    M->dragging_thumb = 0;
+    M->cmd_active = 0;
+    if (visible) SDL_StartTextInput();
+    else SDL_StopTextInput();
+}
+
+int oi_panel_visible(void) {
+    return g_modal.initialized ? g_modal.visible : 1;
+}
+
+int oi_panel_event(SDL_Window *win, SDL_Renderer *rnd, const SDL_Event *ev) {
+    Modal *M = panel(win, rnd);
+    if (ev->type == SDL_WINDOWEVENT && ev->window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+        modal_resize(M, win, rnd);
+        return 0;
+    }
+    if (!M->visible) return 0;
+    return modal_event(M, &M->layout, ev);
+}
+
+void oi_panel_draw(SDL_Window *win, SDL_Renderer *rnd) {
+    Modal *M = panel(win, rnd);
+    if (!M->visible) return;
+    OTR_BEGIN("panel");
+    SDL_RenderSetScale(rnd, M->scale_x, M->scale_y);
+    modal_render(rnd, M, &M->layout);
+    SDL_RenderSetScale(rnd, 1.0f, 1.0f);
+    OTR_END();
+}
+
+/* Default values of row i, for a new row that does not validate yet */
+static void default_row(int i, int N, double baseRadius, Body *out) {
+    Cell tmp[GRID_COLS];
+    const char *row[GRID_COLS];
+    char err[8];
+    default_cells(tmp, i);
+    for (int k = 0; k < GRID_COLS; ++k) row[k] = tmp[k].buf;
+    oi_parse_row(row, i, N, baseRadius, out, err, sizeof(err));
+}
+
+int oi_panel_commit(Body out[], double baseRadius, int *first, int *last) {
+    Modal *M = &g_modal;
+    if (!M->initialized) modal_init(M);
+    Grid *g = &M->grid;
+    int N = g->N;
+    if (N > M->committed_n) mark_dirty(M, M->committed_n, N);
+    int lo = M->dirty_lo, hi = M->dirty_hi < N ? M->dirty_hi : N;
+    *first = *last = 0;
+    if (lo < hi) {
+        *first = lo; *last = hi;
+        for (int i = lo; i < hi; ++i) {
+            const char *row[GRID_COLS];
+            char err[128];
+            for (int k = 0; k < GRID_COLS; ++k) row[k] = g->cells[i*GRID_COLS + k].buf;
+            int ok = oi_parse_row(row, i, N, baseRadius, &out[i], err, sizeof(err));
+            for (int k = 0; k < GRID_COLS; ++k) g->cells[i*GRID_COLS + k].valid = ok;
+            if (ok) {
+                if (M->err_row == i) { M->errmsg[0] = '\0'; M->err_row = -1; }
+                continue;
+            }
+            /* an invalid edit keeps the last good values; a new row gets its defaults */
+            if (i >= M->committed_n) default_row(i, N, baseRadius, &out[i]);
+            snprintf(M->errmsg, sizeof(M->errmsg), "%s", err);
+            M->err_row = i;
+        }
+    }
+    M->dirty_lo = M->dirty_hi = 0;
+    M->committed_n = N;
+    return N;
+}
+
+void oi_panel_sync_row(int i, const Body *b, double baseRadius) {
+    Modal *M = &g_modal;
+    if (!M->initialized || i < 0 || i >= M->grid.N) return;
+    Cell *c = &M->grid.cells[i * GRID_COLS];
+    snprintf(c[0].buf, CELL_BUFSZ, "%.4f", b->ry / baseRadius);
+    snprintf(c[1].buf, CELL_BUFSZ, "%.4f", b->rx / baseRadius);
+    snprintf(c[2].buf, CELL_BUFSZ, "%.4f", b->omega / 0.5);
+    snprintf(c[3].buf, CELL_BUFSZ, "%d", b->size);
+    snprintf(c[4].buf, CELL_BUFSZ, "%d", b->parent + 1);
+    for (int k = 0; k < GRID_COLS; ++k) c[k].valid = 1;
+    if (M->edit_index >= 0 && M->edit_index / GRID_COLS == i) { M->edit_started = 0; M->edit_index = -1; }
+    manual_mode(M);
+}
+
+void oi_panel_select_row(int i) {
+    Modal *M = &g_modal;
+    if (!M->initialized || i < 0 || i >= M->grid.N) return;
+    if (!M->visible) oi_panel_set_visible(1);
+    M->cmd_active = 0;
+    set_focus(M, &M->layout, i * GRID_COLS);
+}
+
+int oi_panel_contains(int x, int y) {
+    const Modal *M = &g_modal;
+    return M->initialized && M->visible && in_rect(x, y, M->layout.modal);
+}
+
+void oi_panel_release(void) {
+    free(g_modal.grid.cells);
+    memset(&g_modal, 0, sizeof(g_modal));
+    oi_text_release();
+}
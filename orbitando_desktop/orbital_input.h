@@ -7,7 +7,10 @@
 extern const SDL_Color palette[];
 #define PALETTE_COUNT 10
 
-#define ORBITAL_MAXOBJ 15
+#define ORBITAL_MAXOBJ (1 << 17)   /* 131072; tables are heap-allocated and grow on demand */
+
+/* text cells per object row: 0=Ry, 1=Rx, 2=w, 3=size, 4=parent (0 = sol, k = objeto k) */
+#define OI_ROW_CELLS 5
 
 typedef struct {
     double rx, ry; /* semi-eixos (pixels) */
@@ -15,21 +18,83 @@ typedef struct {
     double omega;  /* velocidade angular (radians per second) */
     int size;      /* tamanho nominal do quadrado (pixels) */
     SDL_Color color;
+    int parent;    /* objeto em torno do qual orbita (-1 = sol); sempre anterior a este */
 } Body;
 
 /*
- Show modal input panel.
- win/rnd : window and renderer already created.
- out_bodies : array with space for ORBITAL_MAXOBJ entries.
- outN : pointer to int; on success contains selected N.
-
- Returns:
-   1  = OK (user pressed OK)
-  -1  = Cancel (user cancelled)
+ Parameter panel, drawn over the running animation.
+ The panel owns the parameter table; orbital.c routes events to it, draws it
+ after the scene and each frame collects the rows edited since the last frame.
+ It is laid out in window points (HiDPI: drawn with the renderer scaled) and
+ can be docked right, left or centered (Ctrl+D).
+
+ oi_panel_event : returns 1 if the panel used the event, 0 if it is for the
+                  caller (also for window resizes, which both handle),
+                 -1 if the user asked to quit.
+ oi_panel_commit: parses the rows edited since the last call into out[]
+                  (ORBITAL_MAXOBJ entries, rx/ry in pixels for baseRadius);
+                  returns the row count and sets [*first, *last) to the rows
+                  to re-read (empty when nothing changed). A row that fails
+                  validation keeps its previous values in out[] and is flagged
+                  in the table; out[i].ang is only meaningful for new rows.
+ oi_panel_sync_row: show values changed elsewhere (control socket) in row i.
+ oi_panel_select_row: show the panel scrolled to row i, focused on its
+                  first cell (a body picked in the animation).
+ oi_panel_contains: is the window point (x, y) on the visible panel?
 */
-int oi_show_modal(SDL_Window *win, SDL_Renderer *rnd, Body out_bodies[], int *outN);
+void oi_panel_set_visible(int visible);
+int  oi_panel_visible(void);
+int  oi_panel_event(SDL_Window *win, SDL_Renderer *rnd, const SDL_Event *ev);
+void oi_panel_draw(SDL_Window *win, SDL_Renderer *rnd);
+int  oi_panel_commit(Body out[], double baseRadius, int *first, int *last);
+void oi_panel_sync_row(int i, const Body *b, double baseRadius);
+void oi_panel_select_row(int i);
+int  oi_panel_contains(int x, int y);
+void oi_panel_release(void);
 
 /* Optional: override built-in defaults */
 void oi_set_defaults(const double *relx, const double *rely, const double *wvals, const int *gs, int count);
 
+/* Row parser used by the panel. cells holds OI_ROW_CELLS strings;
+   i is the 0-based object index, N the object count. Returns 1 and fills *out,
+   or 0 with a message in errmsg. */
+int oi_parse_row(const char *const cells[], int i, int N, double baseRadius, Body *out, char *errmsg, size_t emsz);
+
+/* Body generator behind the panel's Ctrl+G line (and the tiled sweeps):
+     gen N [rx=a:b] [ry=a:b] [w=w0] [kepler[=0|1]] [size=a:b] [seed=s]
+   rx/ry go linearly from a to b over the N rows; with kepler w follows
+   w0 * (r / r_min)^-1.5. oi_gen_parse validates and rewinds the generator,
+   then each oi_gen_next returns the next row in panel units. */
+typedef struct {
+    int n, kepler;
+    double rx0, rx1, ry0, ry1, w0, s0, s1;
+    unsigned seed;
+    double rmin;       /* state: kepler reference radius, xorshift state, next row */
+    unsigned rng;
+    int i;
+} OiGen;
+
+int  oi_gen_parse(const char *cmd, OiGen *g, char *msg, size_t msz);
+void oi_gen_next(OiGen *g, double *rx, double *ry, double *w, int *size);
+
+/* Sweep specs (tiled view, batch runner): a generator line in which any
+   value may be a comma-separated list, e.g. "gen 100,1000 w=0.5,1 kepler".
+   Each list is an axis and the runs are their cartesian product, the first
+   axis varying fastest. oi_spec_count gives the number of combinations (-1
+   past OI_SPEC_MAX); oi_spec_expand writes combination i as a plain line to
+   cmd and the values it picked ("100 w=0.5") to label. Returns 0 when cmd
+   is too small. Only the first OI_SPEC_TOKENS tokens are read. */
+#define OI_SPEC_TOKENS 32
+#define OI_SPEC_MAX 1000000L
+long oi_spec_count(const char *spec);
+int  oi_spec_expand(const char *spec, long i, char *cmd, size_t csz, char *label, size_t lsz);
+
+/* Text drawing as used by the panel (TTF with bitmap fallback).
+   Rendered strings are cached as textures; oi_set_text_cache(0) disables the
+   cache (for comparison in orbital_bench) and oi_text_release() frees the
+   cache and the fonts. */
+void oi_draw_text(SDL_Renderer *rnd, int x, int y, const char *s, SDL_Color col);
+void oi_set_text_cache(int enabled);
+void oi_text_release(void);
+
 #endif /* ORBITAL_INPUT_H */
\ No newline at end of file
@@ -0,0 +1,286 @@
+/* orbital_query.c
+   Answers "when do planets 3, 5 and 7 line up?" and "when do 2 and 4 come
+   closest?" without running the animation: the searches in orbital_events.h
+   evaluate the closed-form motion and skip ahead wherever nothing can happen.
+
+   The system is read from a file in the panel's Ctrl+C / Ctrl+V format (one
+   body per line: Rx Ry w size [pai]) or built with a generator line, and gets
+   the same start phases as in the app (i*2pi/N). Bodies are numbered from 1,
+   as in the panel. Distances are in the panel's relative radius units, times
+   in seconds of simulation time (the app at speed 1), angles in degrees.
+
+   Usage:
+     ./orbital_query (--file ROWS | --gen "gen N ...") [--t0 S] [--t1 S] [--dt-min S]
+                     --align 3,5,7 [--tol DEG] [--same-side]
+                     --closest [--bodies 1,2,5] [--below D] [--threads T]
+   --align lists the windows where the bodies' directions from the sun fit in
+   --tol degrees (default 1), on either side of the sun unless --same-side.
+   --closest takes every pair among --bodies (default: all) and prints its
+   closest approach, or with --below every window closer than D; pairs are
+   spread over T threads (default: one per CPU).
+   Prints JSON on stdout, one event per line.
+*/
+#include <SDL2/SDL.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "orbital_core.h"
+#include "orbital_events.h"
+#include "orbital_input.h"
+
+#define QUERY_LINE 512
+
+typedef struct {
+    OeEvents ev;
+    int *other;          /* partner body of each event */
+    int cap;
+} RowOut;
+
+typedef struct {
+    const OcBodies *b;
+    const int *set;
+    int m;
+    double t0, t1, dt_min, below;
+    atomic_int next;     /* next set[] index whose pairs are unclaimed */
+    atomic_int failed;
+    RowOut *rows;
+} PairJob;
+
+/* ---- input ---- */
+
+static int parse_list(const char *s, int N, int **out) {
+    int n = 0, cap = 0;
+    int *v = NULL;
+    const char *p = s;
+    while (*p) {
+        char *end;
+        long k = strtol(p, &end, 10);
+        if (end == p || k < 1 || k > N) { free(v); return -1; }
+        if (n == cap) {
+            cap = cap ? cap * 2 : 16;
+            int *nv = realloc(v, sizeof(int) * (size_t)cap);
+            if (!nv) { free(v); return -1; }
+            v = nv;
+        }
+        v[n++] = (int)k - 1;
+        p = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',') { free(v); return -1; }
+    }
+    *out = v;
+    return n;
+}
+
+static int to_core(const Body *in, int N, OcBodies *sys) {
+    if (!oc_reserve(sys, N)) return 0;
+    for (int i = 0; i < N; ++i) {
+        sys->rx[i] = in[i].rx;
+        sys->ry[i] = in[i].ry;
+        sys->ang[i] = in[i].ang;
+        sys->omega[i] = in[i].omega;
+        sys->size[i] = in[i].size;
+        sys->color[i] = (OcColor){ in[i].color.r, in[i].color.g, in[i].color.b, in[i].color.a };
+        sys->parent[i] = in[i].parent;
+    }
+    sys->n = N;
+    return oc_hierarchy_update(sys) < 0;   /* oi_parse_row already checked the order */
+}
+
+/* rows in the paste format; lines that are not 4-5 numbers are skipped */
+static Body* load_rows(const char *path, int *n) {
+    FILE *f = fopen(path, "r");
+    if (!f) { fprintf(stderr, "cannot open %s\n", path); return NULL; }
+    char (*cells)[OI_ROW_CELLS][32] = malloc(sizeof(*cells) * ORBITAL_MAXOBJ);
+    Body *out = malloc(sizeof(Body) * ORBITAL_MAXOBJ);
+    static const int col_cell[OI_ROW_CELLS] = { 1, 0, 2, 3, 4 };   /* Rx Ry w size pai */
+    char line[QUERY_LINE];
+    int N = 0, ok = cells && out;
+    while (ok && fgets(line, sizeof(line), f)) {
+        char *tok[OI_ROW_CELLS + 1];
+        int nt = 0, numeric = 1;
+        for (char *t = strtok(line, " \t,;\r\n"); t && nt <= OI_ROW_CELLS; t = strtok(NULL, " \t,;\r\n")) {
+            char *end;
+            strtod(t, &end);
+            if (*end) numeric = 0;
+            tok[nt++] = t;
+        }
+        if (!numeric || nt < OI_ROW_CELLS - 1 || nt > OI_ROW_CELLS) continue;
+        if (N == ORBITAL_MAXOBJ) { fprintf(stderr, "%s: more than %d bodies\n", path, ORBITAL_MAXOBJ); ok = 0; break; }
+        for (int k = 0; k < OI_ROW_CELLS; ++k)
+            snprintf(cells[N][col_cell[k]], sizeof(cells[N][0]), "%s", k < nt ? tok[k] : "0");
+        ++N;
+    }
+    fclose(f);
+    for (int i = 0; ok && i < N; ++i) {
+        const char *row[OI_ROW_CELLS];
+        char err[128];
+        for (int k = 0; k < OI_ROW_CELLS; ++k) row[k] = cells[i][k];
+        if (!oi_parse_row(row, i, N, 1.0, &out[i], err, sizeof(err))) { fprintf(stderr, "%s: %s\n", path, err); ok = 0; }
+    }
+    free(cells);
+    if (!ok || N == 0) {
+        if (ok) fprintf(stderr, "%s: no bodies\n", path);
+        free(out);
+        return NULL;
+    }
+    *n = N;
+    return out;
+}
+
+static Body* gen_rows(const char *cmd, int *n) {
+    OiGen g;
+    char msg[128];
+    if (!oi_gen_parse(cmd, &g, msg, sizeof(msg))) { fprintf(stderr, "%s\n", msg); return NULL; }
+    Body *out = malloc(sizeof(Body) * (size_t)g.n);
+    if (!out) return NULL;
+    for (int i = 0; i < g.n; ++i) {
+        double rx, ry, w;
+        int size;
+        char srx[32], sry[32], sw[32], ss[16];   /* through text, like the panel */
+        oi_gen_next(&g, &rx, &ry, &w, &size);
+        snprintf(sry, sizeof(sry), "%.4f", ry);
+        snprintf(srx, sizeof(srx), "%.4f", rx);
+        snprintf(sw, sizeof(sw), "%.4f", w);
+        snprintf(ss, sizeof(ss), "%d", size);
+        const char *row[OI_ROW_CELLS] = { sry, srx, sw, ss, "0" };
+        oi_parse_row(row, i, g.n, 1.0, &out[i], msg, sizeof(msg));
+    }
+    *n = g.n;
+    return out;
+}
+
+/* ---- all-pairs search ---- */
+
+static int row_push_other(RowOut *r, int from, int j) {
+    if (r->ev.n > r->cap) {
+        int cap = r->ev.cap;
+        int *no = realloc(r->other, sizeof(int) * (size_t)cap);
+        if (!no) return 0;
+        r->other = no;
+        r->cap = cap;
+    }
+    for (int k = from; k < r->ev.n; ++k) r->other[k] = j;
+    return 1;
+}
+
+/* set[a] against every later body of the set */
+static int pair_row(PairJob *J, int a) {
+    RowOut *r = &J->rows[a];
+    int i = J->set[a];
+    for (int c = a + 1; c < J->m; ++c) {
+        int j = J->set[c], from = r->ev.n;
+        if (J->below > 0) {
+            if (oe_approaches(J->b, i, j, J->t0, J->t1, J->below, J->dt_min, &r->ev) < 0) return 0;
+        } else {
+            if (!oe_events_push(&r->ev, oe_closest(J->b, i, j, J->t0, J->t1, J->dt_min))) return 0;
+        }
+        if (!row_push_other(r, from, j)) return 0;
+    }
+    return 1;
+}
+
+static int pair_worker(void *p) {
+    PairJob *J = p;
+    for (;;) {
+        int a = atomic_fetch_add(&J->next, 1);
+        if (a >= J->m - 1 || atomic_load(&J->failed)) break;
+        if (!pair_row(J, a)) atomic_store(&J->failed, 1);
+    }
+    return 0;
+}
+
+static void print_event(const char *kind, const int *ids, int k, const OeEvent *e, int degrees) {
+    printf("{\"event\":\"%s\",\"bodies\":[", kind);
+    for (int s = 0; s < k; ++s) printf("%s%d", s ? "," : "", ids[s] + 1);
+    printf("],\"t_start\":%.6f,\"t_end\":%.6f,\"t_best\":%.6f,\"%s\":%.6g}\n",
+           e->t_start, e->t_end, e->t_best, degrees ? "spread_deg" : "distance",
+           degrees ? e->value * 180.0 / M_PI : e->value);
+}
+
+int main(int argc, char **argv) {
+    const char *file = NULL, *gen = NULL, *align = NULL, *bodies = NULL;
+    double t0 = 0.0, t1 = 600.0, dt_min = 0.01, tol_deg = 1.0, below = 0.0;
+    int same_side = 0, closest = 0, threads = 0;
+    for (int i = 1; i < argc; ++i) {
+        const char *a = argv[i];
+        const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(a, "--same-side") == 0) { same_side = 1; continue; }
+        if (strcmp(a, "--closest") == 0) { closest = 1; continue; }
+        if (!v) { fprintf(stderr, "missing value for %s\n", a); return 1; }
+        if (strcmp(a, "--file") == 0) file = v;
+        else if (strcmp(a, "--gen") == 0) gen = v;
+        else if (strcmp(a, "--align") == 0) align = v;
+        else if (strcmp(a, "--bodies") == 0) bodies = v;
+        else if (strcmp(a, "--t0") == 0) t0 = atof(v);
+        else if (strcmp(a, "--t1") == 0) t1 = atof(v);
+        else if (strcmp(a, "--dt-min") == 0) dt_min = atof(v);
+        else if (strcmp(a, "--tol") == 0) tol_deg = atof(v);
+        else if (strcmp(a, "--below") == 0) below = atof(v);
+        else if (strcmp(a, "--threads") == 0) threads = atoi(v);
+        else { fprintf(stderr, "unknown option %s\n", a); return 1; }
+        ++i;
+    }
+    if (!file == !gen) { fprintf(stderr, "give one of --file or --gen\n"); return 1; }
+    if (!align && !closest) { fprintf(stderr, "nothing to do: --align and/or --closest\n"); return 1; }
+    if (!(t1 >= t0) || !(dt_min > 0.0) || !(tol_deg >= 0.0) || below < 0.0) {
+        fprintf(stderr, "need t0 <= t1, dt-min > 0, tol >= 0, below >= 0\n");
+        return 1;
+    }
+
+    int N = 0;
+    Body *rows = file ? load_rows(file, &N) : gen_rows(gen, &N);
+    OcBodies sys = {0};
+    if (!rows) return 1;
+    if (!to_core(rows, N, &sys)) { fprintf(stderr, "cannot set up %d bodies\n", N); return 1; }
+    free(rows);
+
+    int rc = 0;
+    if (align) {
+        int *set = NULL;
+        int k = parse_list(align, N, &set);
+        if (k < 2 || k > OE_MAX_SET) {
+            fprintf(stderr, "--align needs 2 to %d bodies in 1..%d\n", OE_MAX_SET, N);
+            return 1;
+        }
+        OeEvents ev = {0};
+        if (oe_alignments(&sys, set, k, t0, t1, tol_deg * M_PI / 180.0, same_side, dt_min, &ev) < 0) {
+            fprintf(stderr, "out of memory\n");
+            rc = 1;
+        }
+        for (int e = 0; e < ev.n; ++e) print_event("align", set, k, &ev.ev[e], 1);
+        oe_events_free(&ev);
+        free(set);
+    }
+
+    if (closest && rc == 0) {
+        int *set = NULL, m = N;
+        if (bodies) m = parse_list(bodies, N, &set);
+        else if ((set = malloc(sizeof(int) * (size_t)N))) for (int i = 0; i < N; ++i) set[i] = i;
+        if (m < 2 || !set) { fprintf(stderr, "--closest needs 2 or more bodies in 1..%d\n", N); return 1; }
+        PairJob J = { &sys, set, m, t0, t1, dt_min, below, 0, 0, calloc((size_t)m, sizeof(RowOut)) };
+        if (!J.rows) { fprintf(stderr, "out of memory\n"); return 1; }
+        if (threads < 1) threads = SDL_GetCPUCount();
+        if (threads > m - 1) threads = m - 1;
+        SDL_Thread **th = calloc((size_t)threads, sizeof(SDL_Thread*));
+        /* rows are claimed one at a time, so long and short rows even out;
+           the main thread works too, and alone if no thread could start */
+        for (int t = 1; th && t < threads; ++t) th[t] = SDL_CreateThread(pair_worker, "query", &J);
+        pair_worker(&J);
+        for (int t = 1; th && t < threads; ++t) if (th[t]) SDL_WaitThread(th[t], NULL);
+        free(th);
+        if (atomic_load(&J.failed)) { fprintf(stderr, "out of memory\n"); rc = 1; }
+        for (int a = 0; a < m; ++a) {
+            RowOut *r = &J.rows[a];
+            for (int e = 0; rc == 0 && e < r->ev.n; ++e) {
+                int ids[2] = { set[a], r->other[e] };
+                print_event(below > 0 ? "approach" : "closest", ids, 2, &r->ev.ev[e], 0);
+            }
+            oe_events_free(&r->ev);
+            free(r->other);
+        }
+        free(J.rows);
+        free(set);
+    }
+    oc_free(&sys);
+    return rc;
+}
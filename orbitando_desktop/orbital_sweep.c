@@ -0,0 +1,300 @@
+/* orbital_sweep.c
+   Tiled multi-system view, see orbital_sweep.h.
+*/
+#include "orbital_sweep.h"
+#include "orbital_input.h"
+#include "orbital_core.h"
+#include "orbital_render.h"
+#include "orbital_trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define CMD_LEN 256
+#define LABEL_LEN 96
+#define TILE_MARGIN 6
+#define ORBIT_SEGMENTS 120
+
+typedef struct Sweep Sweep;
+
+typedef struct {
+    OcBodies sys;
+    OcFrame frame;
+    char label[LABEL_LEN];
+    /* written by the main thread only while the worker is idle */
+    float ox, oy, k;          /* tile center and scale from the reference radius */
+    double dt;
+    SDL_Vertex *out;          /* 4 per body, this frame's slice of the batch */
+    SDL_sem *go;
+    SDL_Thread *thread;
+    Sweep *sw;
+} Tile;
+
+struct Sweep {
+    int K, total;
+    Tile *tiles;
+    int *first;               /* vertex offset of each tile, in bodies */
+    SDL_sem *done;
+    int quit;
+    OrAtlas atlas;
+    SDL_Vertex *verts[2];     /* double-buffered batch */
+    int *idx;
+    SDL_Texture *bg;
+    int vw, vh;
+    double base0;             /* pixels per unit of relative radius in sys */
+    double extent;            /* largest orbit + half sprite over all tiles, sys pixels */
+    SDL_Point *scratch;
+};
+
+/* Expand the spec into K generator lines and labels. */
+static int sweep_plan(const char *spec, char (*cmds)[CMD_LEN], char (*labels)[LABEL_LEN], int *K, char *msg, size_t msz) {
+    long k = oi_spec_count(spec);
+    if (k < 0) { snprintf(msg, msz, "sweep: more than %ld combinations", OI_SPEC_MAX); return 0; }
+    if (k > OSW_MAX_TILES) { snprintf(msg, msz, "sweep: %ld tiles, at most %d", k, OSW_MAX_TILES); return 0; }
+    for (int i = 0; i < (int)k; ++i) {
+        if (!oi_spec_expand(spec, i, cmds[i], CMD_LEN, labels[i], LABEL_LEN)) {
+            snprintf(msg, msz, "sweep: spec too long");
+            return 0;
+        }
+    }
+    *K = (int)k;
+    return 1;
+}
+
+static int tile_init(Tile *t, const char *cmd, double base0, char *msg, size_t msz) {
+    OiGen gen;
+    if (!oi_gen_parse(cmd, &gen, msg, msz)) return 0;
+    int n = gen.n;
+    if (!oc_reserve(&t->sys, n) || !oc_frame_reserve(&t->frame, n)) { snprintf(msg, msz, "sweep: out of memory"); return 0; }
+    for (int i = 0; i < n; ++i) {
+        double rx, ry, w;
+        int size;
+        oi_gen_next(&gen, &rx, &ry, &w, &size);
+        SDL_Color c = palette[i % PALETTE_COUNT];
+        t->sys.rx[i] = rx * base0;
+        t->sys.ry[i] = ry * base0;
+        t->sys.omega[i] = w * 0.5;
+        t->sys.size[i] = size;
+        t->sys.color[i] = (OcColor){ c.r, c.g, c.b, c.a };
+        t->sys.parent[i] = -1;
+    }
+    t->sys.n = n;
+    oc_hierarchy_update(&t->sys);
+    oc_init_phases(&t->sys);
+    return 1;
+}
+
+/* Step one system and write its quads; the tile is centered at (0, 0) in
+   sys units and placed by the quad transform. */
+static int tile_thread(void *arg) {
+    Tile *t = arg;
+    Sweep *sw = t->sw;
+    OTR_THREAD_NAME("tile");
+    for (;;) {
+        SDL_SemWait(t->go);
+        if (sw->quit) break;
+        OTR_BEGIN("tile step");
+        int n = t->sys.n;
+        oc_advance(&t->sys, 0, n, t->dt);
+        oc_positions(&t->sys, 0, n, 0.0, 0.0, t->frame.x, t->frame.y);
+        oc_propagate(&t->sys, 0.0, 0.0, t->frame.x, t->frame.y);
+        oc_build_draw_list(&t->sys, 0, n, t->frame.x, t->frame.y, t->frame.items);
+        for (int i = 0; i < n; ++i)
+            or_atlas_quad(&sw->atlas, &t->frame.items[i], t->sys.color[i], t->ox, t->oy, t->k, &t->out[i*4]);
+        OTR_END();
+        SDL_SemPost(sw->done);
+    }
+    return 0;
+}
+
+/* Near-square grid for the drawable's aspect; only while workers are idle. */
+static void sweep_layout(Sweep *sw) {
+    int cols = (int)ceil(sqrt((double)sw->K * sw->vw / sw->vh));
+    if (cols < 1) cols = 1;
+    if (cols > sw->K) cols = sw->K;
+    int rows = (sw->K + cols - 1) / cols;
+    float tw = (float)sw->vw / cols, th = (float)sw->vh / rows;
+    for (int i = 0; i < sw->K; ++i) {
+        Tile *t = &sw->tiles[i];
+        t->ox = tw * (float)(i % cols) + tw * 0.5f;
+        t->oy = th * (float)(i / cols) + th * 0.5f;
+        t->k = (float)((fmin(tw, th) / 2.0 - TILE_MARGIN) / sw->extent);   /* one scale for all tiles */
+    }
+}
+
+/* all tiles' orbits, borders and labels in one texture */
+static int sweep_background(Sweep *sw, SDL_Renderer *rnd) {
+    if (sw->bg) SDL_DestroyTexture(sw->bg);
+    sw->bg = SDL_CreateTexture(rnd, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, sw->vw, sw->vh);
+    if (!sw->bg) return 0;
+    OTR_BEGIN("sweep background");
+    SDL_Texture *old = SDL_GetRenderTarget(rnd);
+    SDL_SetRenderTarget(rnd, sw->bg);
+    SDL_SetRenderDrawBlendMode(rnd, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(rnd, 0,0,0,255);
+    SDL_RenderClear(rnd);
+    for (int i = 0; i < sw->K; ++i) {
+        const Tile *t = &sw->tiles[i];
+        int cx = (int)t->ox, cy = (int)t->oy;
+        int half = (int)(sw->extent * t->k) + TILE_MARGIN;
+        SDL_Rect frame = { cx - half, cy - half, 2*half, 2*half };
+        SDL_SetRenderDrawColor(rnd, 60,60,75,255);
+        SDL_RenderDrawRect(rnd, &frame);
+        SDL_SetRenderDrawColor(rnd, 64,200,220,255);
+        for (int b = 0; b < t->sys.n; ++b) {
+            if (t->sys.parent[b] >= 0) continue;
+            or_tessellate_ellipse(cx, cy, (int)lround(t->sys.rx[b] * t->k), (int)lround(t->sys.ry[b] * t->k),
+                                  ORBIT_SEGMENTS, sw->scratch);
+            SDL_RenderDrawLines(rnd, sw->scratch, ORBIT_SEGMENTS + 1);
+        }
+        int r = (int)fmax(2.0, 8.0 * t->k);
+        SDL_SetRenderDrawColor(rnd, 255,215,0,255);
+        SDL_Rect sun = { cx - r, cy - r, 2*r, 2*r };
+        SDL_RenderFillRect(rnd, &sun);
+        oi_draw_text(rnd, frame.x + 6, frame.y + 4, t->label, (SDL_Color){200,200,210,255});
+    }
+    SDL_SetRenderTarget(rnd, old);
+    OTR_END();
+    return 1;
+}
+
+static void sweep_free(Sweep *sw) {
+    if (sw->tiles) {
+        /* workers are idle here: wake them once more to exit */
+        sw->quit = 1;
+        for (int i = 0; i < sw->K; ++i) if (sw->tiles[i].thread) SDL_SemPost(sw->tiles[i].go);
+        for (int i = 0; i < sw->K; ++i) {
+            Tile *t = &sw->tiles[i];
+            if (t->thread) SDL_WaitThread(t->thread, NULL);
+            if (t->go) SDL_DestroySemaphore(t->go);
+            oc_free(&t->sys);
+            oc_frame_free(&t->frame);
+        }
+    }
+    if (sw->done) SDL_DestroySemaphore(sw->done);
+    if (sw->bg) SDL_DestroyTexture(sw->bg);
+    or_atlas_free(&sw->atlas);
+    free(sw->tiles); free(sw->first); free(sw->verts[0]); free(sw->verts[1]); free(sw->idx); free(sw->scratch);
+}
+
+/* hand every tile its dt and output slice; the workers run while we draw */
+static void sweep_kick(Sweep *sw, SDL_Vertex *out, double dt) {
+    for (int i = 0; i < sw->K; ++i) {
+        Tile *t = &sw->tiles[i];
+        t->dt = dt;
+        t->out = out + (size_t)sw->first[i] * 4;
+        SDL_SemPost(t->go);
+    }
+}
+
+static void sweep_wait(Sweep *sw) {
+    OTR_BEGIN("wait tiles");
+    for (int i = 0; i < sw->K; ++i) SDL_SemWait(sw->done);
+    OTR_END();
+}
+
+int osw_run(SDL_Renderer *rnd, const char *spec, const char *trace_path) {
+    Sweep sw = {0};
+    char msg[160];
+    char (*cmds)[CMD_LEN] = malloc(sizeof(*cmds) * OSW_MAX_TILES);
+    char (*labels)[LABEL_LEN] = malloc(sizeof(*labels) * OSW_MAX_TILES);
+    int ok = cmds && labels && sweep_plan(spec, cmds, labels, &sw.K, msg, sizeof(msg));
+    if (!cmds || !labels) snprintf(msg, sizeof(msg), "sweep: out of memory");
+
+    SDL_GetRendererOutputSize(rnd, &sw.vw, &sw.vh);
+    sw.base0 = oc_base_radius(sw.vw, sw.vh);
+    if (ok) {
+        sw.tiles = calloc((size_t)sw.K, sizeof(Tile));
+        sw.first = malloc(sizeof(int) * (size_t)sw.K);
+        ok = sw.tiles && sw.first;
+        if (!ok) snprintf(msg, sizeof(msg), "sweep: out of memory");
+    }
+    for (int i = 0; ok && i < sw.K; ++i) {
+        Tile *t = &sw.tiles[i];
+        t->sw = &sw;
+        snprintf(t->label, sizeof(t->label), "%s", labels[i][0] ? labels[i] : "(sem eixo)");
+        ok = tile_init(t, cmds[i], sw.base0, msg, sizeof(msg));
+        if (ok) {
+            for (int b = 0; b < t->sys.n; ++b)
+                sw.extent = fmax(sw.extent, fmax(t->sys.rx[b], t->sys.ry[b]) + t->sys.size[b] * 0.5);
+            sw.first[i] = sw.total;
+            sw.total += t->sys.n;
+            if (sw.total > OSW_MAX_BODIES) { snprintf(msg, sizeof(msg), "sweep: more than %d bodies in all tiles", OSW_MAX_BODIES); ok = 0; }
+        }
+    }
+    free(cmds); free(labels);
+    if (ok) {
+        sw.verts[0] = malloc(sizeof(SDL_Vertex) * 4 * (size_t)sw.total);
+        sw.verts[1] = malloc(sizeof(SDL_Vertex) * 4 * (size_t)sw.total);
+        sw.idx = malloc(sizeof(int) * 6 * (size_t)sw.total);
+        sw.scratch = malloc(sizeof(SDL_Point) * (ORBIT_SEGMENTS + 1));
+        ok = sw.verts[0] && sw.verts[1] && sw.idx && sw.scratch;
+        if (!ok) snprintf(msg, sizeof(msg), "sweep: out of memory");
+        else or_quad_indices(sw.idx, sw.total);
+    }
+    if (ok && !or_atlas_build(&sw.atlas, rnd)) { snprintf(msg, sizeof(msg), "sweep: atlas: %s", SDL_GetError()); ok = 0; }
+    if (ok && !(sw.done = SDL_CreateSemaphore(0))) { snprintf(msg, sizeof(msg), "sweep: %s", SDL_GetError()); ok = 0; }
+    for (int i = 0; ok && i < sw.K; ++i) {
+        Tile *t = &sw.tiles[i];
+        if (!(t->go = SDL_CreateSemaphore(0)) || !(t->thread = SDL_CreateThread(tile_thread, "orbital_tile", t))) {
+            snprintf(msg, sizeof(msg), "sweep: %s", SDL_GetError());
+            ok = 0;
+        }
+    }
+    if (!ok) {
+        fprintf(stderr, "%s\n", msg);
+        sweep_free(&sw);
+        return 1;
+    }
+    printf("sweep: %d tiles, %d bodies\n", sw.K, sw.total);
+    sweep_layout(&sw);
+    sweep_background(&sw, rnd);
+
+    int cur = 0, running = 1, paused = 0, resized = 0;
+    sweep_kick(&sw, sw.verts[cur], 0.0);
+    Uint64 last = SDL_GetPerformanceCounter();
+    double freq = (double)SDL_GetPerformanceFrequency();
+    SDL_Event ev;
+    while (running) {
+        Uint64 now = SDL_GetPerformanceCounter();
+        double dt = (now - last) / freq;
+        last = now;
+        if (dt > 0.1) dt = 0.1;
+        if (paused) dt = 0;
+
+        OTR_BEGIN("frame");
+        OTR_BEGIN("events");
+        while (SDL_PollEvent(&ev)) {
+            if (ev.type == SDL_QUIT) running = 0;
+            if (ev.type == SDL_WINDOWEVENT && ev.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) resized = 1;
+            if (ev.type != SDL_KEYDOWN) continue;
+            if (ev.key.keysym.sym == SDLK_ESCAPE) running = 0;
+            if (ev.key.keysym.sym == SDLK_SPACE) paused = !paused;
+            if (ev.key.keysym.sym == SDLK_F12 && otr_dump(trace_path)) printf("trace: %s\n", trace_path);
+        }
+        OTR_END();
+
+        /* frame in verts[cur] is complete; start the next one into the other buffer */
+        sweep_wait(&sw);
+        if (resized) {
+            resized = 0;
+            SDL_GetRendererOutputSize(rnd, &sw.vw, &sw.vh);
+            sweep_layout(&sw);
+            sweep_background(&sw, rnd);
+            /* verts[cur] was placed with the old layout: redo it in place */
+            sweep_kick(&sw, sw.verts[cur], 0.0);
+            sweep_wait(&sw);
+        }
+        sweep_kick(&sw, sw.verts[cur ^ 1], dt);
+
+        if (sw.bg) SDL_RenderCopy(rnd, sw.bg, NULL, NULL);
+        OTR_SCOPE("bodies") SDL_RenderGeometry(rnd, sw.atlas.tex, sw.verts[cur], sw.total * 4, sw.idx, sw.total * 6);
+        OTR_SCOPE("present") SDL_RenderPresent(rnd);
+        cur ^= 1;
+        OTR_END();
+    }
+    sweep_wait(&sw);
+    sweep_free(&sw);
+    return 0;
+}
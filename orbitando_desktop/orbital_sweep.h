@@ -0,0 +1,32 @@
+#ifndef ORBITAL_SWEEP_H
+#define ORBITAL_SWEEP_H
+
+/* orbital_sweep.h
+   Parameter sweeps: K independent systems side by side in one window, one
+   viewport (tile) per parameter set, to compare configurations at a glance.
+
+   The spec is a generator line (oi_gen_parse) in which any value may be a
+   comma-separated list; every list is a sweep axis and the tiles are their
+   cartesian product, e.g.
+     gen 400 rx=0.1:1.4 ry=0.08:1.2 size=4:10 w=0.5,1,2,4 kepler=0,1
+   gives 8 tiles labelled "w=0.5 kepler=0" ... "w=4 kepler=1".
+
+   Each system is stepped on its own worker thread, which also turns its draw
+   list into textured quads over one shared sprite atlas (OrAtlas). The frame
+   is then a single background blit (all tiles' orbits live in one texture)
+   plus a single SDL_RenderGeometry call for every body of every tile, so
+   draw-call count does not grow with K. Workers fill the next frame's vertex
+   buffer while the main thread submits the current one.
+*/
+
+#include <SDL2/SDL.h>
+
+#define OSW_MAX_TILES  64
+#define OSW_MAX_BODIES (1 << 18)   /* all tiles together */
+
+/* Run the sweep until Esc or the window closes. Space pauses, F12 writes the
+   trace (orbital_trace.h) to trace_path. Returns 0, or 1 with a message on
+   stderr when the spec is invalid or memory runs out. */
+int osw_run(SDL_Renderer *rnd, const char *spec, const char *trace_path);
+
+#endif /* ORBITAL_SWEEP_H */
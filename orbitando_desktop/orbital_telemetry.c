@@ -0,0 +1,207 @@
+/* orbital_telemetry.c
+   Shared-memory telemetry ring, see orbital_telemetry.h for the layout.
+*/
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L   /* clock_gettime, shm_open, ftruncate under -std=c17 */
+#endif
+#include "orbital_telemetry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#define ALIGN64(v) (((v) + 63u) & ~(uint64_t)63u)
+
+uint64_t ot_now_ns(void) {
+#ifdef _WIN32
+    LARGE_INTEGER c, f;
+    QueryPerformanceCounter(&c);
+    QueryPerformanceFrequency(&f);
+    return (uint64_t)((double)c.QuadPart * 1e9 / (double)f.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static OtSlot* slot_at(const OtHeader *h, uint64_t frame) {
+    return (OtSlot*)((char*)h + h->slot_offset + (frame % h->slots) * h->slot_bytes);
+}
+
+static double* slot_array(OtSlot *s, uint64_t off) {
+    return (double*)((char*)s + off);
+}
+
+#ifdef _WIN32
+/* "/orbitando" -> "Local\orbitando" */
+static void win_name(char *dst, size_t sz, const char *name) {
+    snprintf(dst, sz, "Local\\%s", name[0] == '/' ? name + 1 : name);
+}
+#endif
+
+static void* map_segment(OtShm *t, const char *name, size_t bytes, int create) {
+#ifdef _WIN32
+    char wname[80];
+    win_name(wname, sizeof(wname), name);
+    HANDLE m = create
+        ? CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                             (DWORD)((uint64_t)bytes >> 32), (DWORD)bytes, wname)
+        : OpenFileMappingA(FILE_MAP_READ, FALSE, wname);
+    if (!m) return NULL;
+    void *p = MapViewOfFile(m, create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, create ? bytes : 0);
+    if (!p) { CloseHandle(m); return NULL; }
+    if (!create) {
+        MEMORY_BASIC_INFORMATION mi;
+        VirtualQuery(p, &mi, sizeof(mi));
+        bytes = mi.RegionSize;
+    }
+    t->mapping = m;
+#else
+    int fd;
+    if (create) {
+        shm_unlink(name);   /* a segment left by a crashed run is replaced */
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0) return NULL;
+        if (ftruncate(fd, (off_t)bytes) != 0) { close(fd); shm_unlink(name); return NULL; }
+    } else {
+        struct stat st;
+        fd = shm_open(name, O_RDONLY, 0);
+        if (fd < 0) return NULL;
+        if (fstat(fd, &st) != 0) { close(fd); return NULL; }
+        bytes = (size_t)st.st_size;
+    }
+    void *p = mmap(NULL, bytes, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) { if (create) shm_unlink(name); return NULL; }
+#endif
+    t->bytes = bytes;
+    t->owner = create;
+    snprintf(t->name, sizeof(t->name), "%s", name);
+    return p;
+}
+
+int ot_open(OtShm *t, const char *name, int capacity) {
+    if (capacity < 1) capacity = 1;
+    uint64_t slot_x = ALIGN64(sizeof(OtSlot));
+    uint64_t arr = ALIGN64((uint64_t)capacity * sizeof(double));
+    uint64_t slot_bytes = slot_x + 3 * arr;
+    uint64_t slot_offset = ALIGN64(sizeof(OtHeader));
+    size_t bytes = (size_t)(slot_offset + OT_SLOTS * slot_bytes);
+
+    OtHeader *h = map_segment(t, name, bytes, 1);
+    if (!h) { fprintf(stderr, "telemetry: cannot create shared memory %s\n", name); return 0; }
+    memset(h, 0, bytes);
+    h->version = OT_VERSION;
+    h->slots = OT_SLOTS;
+    h->capacity = (uint32_t)capacity;
+    h->slot_offset = slot_offset;
+    h->slot_bytes = slot_bytes;
+    h->slot_x = slot_x;
+    h->slot_y = slot_x + arr;
+    h->slot_ang = slot_x + 2 * arr;
+    atomic_store_explicit(&h->head, 0, memory_order_relaxed);
+    /* readers check the magic before anything else */
+    atomic_thread_fence(memory_order_release);
+    h->magic = OT_MAGIC;
+    t->hdr = h;
+    return 1;
+}
+
+void ot_publish(OtShm *t, int n, const double *x, const double *y, const double *ang) {
+    OtHeader *h = t->hdr;
+    if (!h) return;
+    if (n < 0) n = 0;
+    if ((uint32_t)n > h->capacity) n = (int)h->capacity;
+    uint64_t f = atomic_load_explicit(&h->head, memory_order_relaxed) + 1;
+    OtSlot *s = slot_at(h, f);
+
+    atomic_store_explicit(&s->seq, 2 * f - 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);   /* odd seq is visible before the data changes */
+    s->frame = f;
+    s->t_ns = ot_now_ns();
+    s->n = (uint32_t)n;
+    memcpy(slot_array(s, h->slot_x), x, sizeof(double) * (size_t)n);
+    memcpy(slot_array(s, h->slot_y), y, sizeof(double) * (size_t)n);
+    memcpy(slot_array(s, h->slot_ang), ang, sizeof(double) * (size_t)n);
+    atomic_store_explicit(&s->seq, 2 * f, memory_order_release);
+    atomic_store_explicit(&h->head, f, memory_order_release);
+}
+
+int ot_attach(OtShm *t, const char *name) {
+    OtHeader *h = map_segment(t, name, 0, 0);
+    if (!h) return 0;
+    if (t->bytes < sizeof(OtHeader) || h->magic != OT_MAGIC || h->version != OT_VERSION ||
+        h->slot_offset + (uint64_t)h->slots * h->slot_bytes > t->bytes) {
+        t->hdr = h;
+        t->owner = 0;
+        ot_close(t);
+        return 0;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    t->hdr = h;
+    return 1;
+}
+
+static int snapshot_reserve(OtSnapshot *s, int n) {
+    if (n <= s->cap) return 1;
+    double *nx = realloc(s->x, sizeof(double) * (size_t)n); if (!nx) return 0; s->x = nx;
+    double *ny = realloc(s->y, sizeof(double) * (size_t)n); if (!ny) return 0; s->y = ny;
+    double *na = realloc(s->ang, sizeof(double) * (size_t)n); if (!na) return 0; s->ang = na;
+    s->cap = n;
+    return 1;
+}
+
+int ot_read_latest(const OtShm *t, OtSnapshot *out) {
+    const OtHeader *h = t->hdr;
+    if (!h) return -1;
+    if (!snapshot_reserve(out, (int)h->capacity)) return -1;
+    /* a retry means the publisher lapped the ring during the copy: take the
+       newer head and try again */
+    for (int tries = 0; tries < 8; ++tries) {
+        uint64_t f = atomic_load_explicit((_Atomic uint64_t*)&h->head, memory_order_acquire);
+        if (f == 0 || f == out->frame) return 0;
+        OtSlot *s = slot_at(h, f);
+        uint64_t s1 = atomic_load_explicit(&s->seq, memory_order_acquire);
+        if (s1 != 2 * f) continue;
+        uint32_t n = s->n;
+        if (n > h->capacity) n = h->capacity;
+        uint64_t t_ns = s->t_ns;
+        memcpy(out->x, slot_array(s, h->slot_x), sizeof(double) * n);
+        memcpy(out->y, slot_array(s, h->slot_y), sizeof(double) * n);
+        memcpy(out->ang, slot_array(s, h->slot_ang), sizeof(double) * n);
+        atomic_thread_fence(memory_order_acquire);   /* the copy happens before the re-check */
+        if (atomic_load_explicit(&s->seq, memory_order_relaxed) != s1) continue;
+        out->frame = f;
+        out->t_ns = t_ns;
+        out->n = (int)n;
+        return 1;
+    }
+    return 0;
+}
+
+void ot_snapshot_free(OtSnapshot *s) {
+    free(s->x); free(s->y); free(s->ang);
+    memset(s, 0, sizeof(*s));
+}
+
+void ot_close(OtShm *t) {
+    if (!t->hdr) return;
+#ifdef _WIN32
+    UnmapViewOfFile(t->hdr);
+    CloseHandle(t->mapping);
+#else
+    munmap(t->hdr, t->bytes);
+    if (t->owner) shm_unlink(t->name);
+#endif
+    t->hdr = NULL;
+}
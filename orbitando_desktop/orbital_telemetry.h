@@ -0,0 +1,85 @@
+#ifndef ORBITAL_TELEMETRY_H
+#define ORBITAL_TELEMETRY_H
+
+/* orbital_telemetry.h
+   Live body positions in shared memory (POSIX shm_open, or a named file
+   mapping on Windows) for external analysis and overlay tools.
+
+   The segment is a header followed by a ring of OT_SLOTS snapshots. The
+   publisher fills the slot after the newest one and then advances `head`;
+   it never waits for readers. Each slot carries a sequence counter used as a
+   seqlock: odd while the slot is being written, 2*frame once complete. A
+   reader copies the newest slot and keeps the copy only if the counter was
+   even and unchanged across the copy; with several slots in the ring the
+   publisher is OT_SLOTS-1 frames away from the slot being read, so retries
+   are rare.
+
+   Segment layout (all offsets from the start of the mapping, little endian):
+     OtHeader                       at 0
+     slot k                         at slot_offset + k*slot_bytes
+       OtSlot                       slot header
+       double x[capacity]           at +slot_x   (pixels, renderer output)
+       double y[capacity]           at +slot_y
+       double ang[capacity]         at +slot_ang (radians, own orbit phase)
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+#define OT_MAGIC   0x4D4C544Fu   /* "OTLM" */
+#define OT_VERSION 1u
+#define OT_SLOTS   4
+#define OT_DEFAULT_NAME "/orbitando"
+
+typedef struct {
+    uint32_t magic, version;
+    uint32_t slots, capacity;      /* ring length, bodies per slot */
+    uint64_t slot_offset, slot_bytes;
+    uint64_t slot_x, slot_y, slot_ang;
+    _Atomic uint64_t head;         /* newest complete frame, 0 = none yet */
+} OtHeader;
+
+typedef struct {
+    _Atomic uint64_t seq;          /* odd = being written, 2*frame = complete */
+    uint64_t frame;                /* 1, 2, 3, ... */
+    uint64_t t_ns;                 /* CLOCK_MONOTONIC (QueryPerformanceCounter on Windows) */
+    uint32_t n;                    /* bodies in this snapshot, <= capacity */
+    uint32_t pad;
+} OtSlot;
+
+typedef struct {
+    OtHeader *hdr;                 /* NULL = not open */
+    size_t bytes;
+    int owner;                     /* publisher: unlinks the name on close */
+    char name[64];
+#ifdef _WIN32
+    void *mapping;
+#endif
+} OtShm;
+
+/* Publisher. ot_open creates (or replaces) the segment for up to capacity
+   bodies; returns 1, or 0 with a message on stderr. */
+int  ot_open(OtShm *t, const char *name, int capacity);
+/* Publish one frame; bodies past the capacity are left out. Never blocks. */
+void ot_publish(OtShm *t, int n, const double *x, const double *y, const double *ang);
+void ot_close(OtShm *t);
+
+/* Reader side. ot_attach maps an existing segment read-only. */
+int  ot_attach(OtShm *t, const char *name);
+
+/* Copy of one snapshot; the arrays are owned by the reader and grown as needed */
+typedef struct {
+    uint64_t frame, t_ns;
+    int n, cap;
+    double *x, *y, *ang;
+} OtSnapshot;
+
+/* Copy the newest frame into *out if it is newer than out->frame.
+   Returns 1 = new snapshot, 0 = nothing new yet, -1 = error. */
+int  ot_read_latest(const OtShm *t, OtSnapshot *out);
+void ot_snapshot_free(OtSnapshot *s);
+
+uint64_t ot_now_ns(void);
+
+#endif /* ORBITAL_TELEMETRY_H */
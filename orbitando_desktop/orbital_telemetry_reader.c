@@ -0,0 +1,82 @@
+/* orbital_telemetry_reader.c
+   Example reader for the telemetry published by `orbitando --telemetry`.
+   Attaches read-only, polls the newest snapshot and prints one line per
+   second: frames received and skipped, latency from publish to copy, copy
+   time, and the first bodies' positions.
+
+   gcc -O2 -Wall orbital_telemetry_reader.c orbital_telemetry.c -o orbital_telemetry_reader   (Linux: add -lrt on glibc < 2.34)
+   ./orbital_telemetry_reader [--name /orbitando] [--show K] [--seconds S]
+*/
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L   /* nanosleep under -std=c17 */
+#endif
+#include "orbital_telemetry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+static void nap_ms(int ms) { Sleep(ms); }
+#else
+#include <time.h>
+static void nap_ms(int ms) {
+    struct timespec ts = { ms / 1000, (long)(ms % 1000) * 1000000L };
+    nanosleep(&ts, NULL);
+}
+#endif
+
+int main(int argc, char *argv[]) {
+    const char *name = OT_DEFAULT_NAME;
+    int show = 3, seconds = 0;
+    for (int a = 1; a < argc; ++a) {
+        if (strcmp(argv[a], "--name") == 0 && a + 1 < argc) name = argv[++a];
+        else if (strcmp(argv[a], "--show") == 0 && a + 1 < argc) show = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--seconds") == 0 && a + 1 < argc) seconds = atoi(argv[++a]);
+        else {
+            fprintf(stderr, "usage: %s [--name /orbitando] [--show K] [--seconds S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    OtShm shm = {0};
+    while (!ot_attach(&shm, name)) {
+        fprintf(stderr, "waiting for %s (run orbitando --telemetry) ...\n", name);
+        nap_ms(1000);
+    }
+    printf("attached %s: capacity %u bodies, %u slots\n", name, shm.hdr->capacity, shm.hdr->slots);
+
+    OtSnapshot snap = {0};
+    uint64_t window_start = ot_now_ns(), last_frame = 0;
+    long got = 0, skipped = 0;
+    double lat_sum = 0, copy_sum = 0;
+    for (int elapsed = 0; !seconds || elapsed < seconds; ) {
+        uint64_t t0 = ot_now_ns();
+        int r = ot_read_latest(&shm, &snap);
+        uint64_t t1 = ot_now_ns();
+        if (r < 0) { fprintf(stderr, "read failed\n"); break; }
+        if (r == 1) {
+            if (last_frame && snap.frame > last_frame + 1) skipped += (long)(snap.frame - last_frame - 1);
+            last_frame = snap.frame;
+            ++got;
+            lat_sum += (double)(t1 - snap.t_ns);
+            copy_sum += (double)(t1 - t0);
+        } else {
+            nap_ms(1);
+        }
+        if (t1 - window_start >= 1000000000u) {
+            printf("frame %llu  n %d  %ld/s  skipped %ld  latency %.3f ms  copy %.3f ms\n",
+                   (unsigned long long)snap.frame, snap.n, got, skipped,
+                   got ? lat_sum / got / 1e6 : 0.0, got ? copy_sum / got / 1e6 : 0.0);
+            for (int i = 0; i < show && i < snap.n; ++i)
+                printf("  [%d] x %.1f  y %.1f  ang %.3f\n", i, snap.x[i], snap.y[i], snap.ang[i]);
+            fflush(stdout);
+            got = skipped = 0; lat_sum = copy_sum = 0;
+            window_start = t1;
+            ++elapsed;
+        }
+    }
+    ot_snapshot_free(&snap);
+    ot_close(&shm);
+    return 0;
+}
@@ -6,6 +6,8 @@ document.addEventListener('DOMContentLoaded', function() {
   const applyBtn = document.getElementById('applyBtn');
   const startBtn = document.getElementById('startBtn');
   const stopBtn = document.getElementById('stopBtn');
+  const trailsChk = document.getElementById('trailsChk');
+  const traceBtn = document.getElementById('traceBtn');
   const canvas = document.getElementById('mainCanvas');
 
   if (!rowsContainer || !nInput || !buildBtn) {
@@ -31,6 +33,7 @@ document.addEventListener('DOMContentLoaded', function() {
         <div class="hdr-col" data-col="ry">semi-eixo-y</div>
         <div class="hdr-col" data-col="w">w</div>
         <div class="hdr-col" data-col="s">size</div>
+        <div class="hdr-col" data-col="p">pai</div>
       `;
       Array.from(header.querySelectorAll('.hdr-col')).forEach(c=>{
         c.style.boxSizing = 'border-box';
@@ -58,13 +61,15 @@ document.addEventListener('DOMContentLoaded', function() {
       const ryEl = firstRow.querySelector('.ry');
       const wEl  = firstRow.querySelector('.w');
       const sEl  = firstRow.querySelector('.s');
+      const pEl  = firstRow.querySelector('.p');
 
       const items = [
         { el: labelEl, key: 'label' },
         { el: rxEl, key: 'rx' },
         { el: ryEl, key: 'ry' },
         { el: wEl,  key: 'w'  },
-        { el: sEl,  key: 's'  }
+        { el: sEl,  key: 's'  },
+        { el: pEl,  key: 'p'  }
       ];
 
       const computed = items.map(it => {
@@ -78,7 +83,7 @@ document.addEventListener('DOMContentLoaded', function() {
         const info = computed.find(c => c.key === key);
         if (!info) return;
         col.style.width = info.width + 'px';
-        if (key === 'w' || key === 's') col.style.textAlign = 'center';
+        if (key === 'w' || key === 's' || key === 'p') col.style.textAlign = 'center';
         else col.style.textAlign = 'left';
       });
 
@@ -134,6 +139,7 @@ document.addEventListener('DOMContentLoaded', function() {
         <input class="ry" type="text" value="${rely.toFixed(2)}" style="width:6.5em">
         <input class="w"  type="text" value="${wv.toFixed(2)}" style="width:6.5em">
         <input class="s"  type="number" value="${gs * 4}" min="2" max="200" style="width:6.5em">
+        <input class="p"  type="number" value="0" min="0" max="${i}" title="0 = sol; k = orbita o objeto k" style="width:6.5em">
       `;
       rowsContainer.appendChild(div);
     }
@@ -183,34 +189,72 @@ document.addEventListener('DOMContentLoaded', function() {
       }
     } catch (e) { console.warn('set_canvas_size failed', e); }
 
-    // apply / start / stop handlers (same logic as debug)
-    applyBtn.addEventListener('click', function(){
-      const rows = rowsContainer.querySelectorAll('.row');
-      const n = rows.length;
-      if (n === 0) { console.warn('no rows to apply'); return; }
-      const rxs = new Float64Array(n);
-      const rys = new Float64Array(n);
-      const ws  = new Float64Array(n);
-      const ss  = new Int32Array(n);
-      for (let i=0;i<n;i++) {
-        const row = rows[i];
-        rxs[i] = parseFloat(row.querySelector('.rx').value) || 0.2;
-        rys[i] = parseFloat(row.querySelector('.ry').value) || 0.2;
-        ws[i]  = parseFloat(row.querySelector('.w').value)  || 1.0;
-        ss[i]  = parseInt(row.querySelector('.s').value,10) || 16;
+    // Shared-memory bridge: typed-array views over the persistent wasm arrays
+    // (see Bridge in wasm_orbital.c). Views are mapped once and only re-created
+    // when wasm moves the arrays (layout_version) or the heap grows.
+    function createBridge(Module) {
+      if (typeof Module._get_bridge !== 'function') return null;
+      const hdr = Module._get_bridge() >> 2;
+      let views = null, layout = -1;
+      function map() {
+        const H = Module.HEAPU32, cap = H[hdr];
+        views = {
+          capacity: cap,
+          rx:    new Float64Array(H.buffer, H[hdr + 5], cap),
+          ry:    new Float64Array(H.buffer, H[hdr + 6], cap),
+          w:     new Float64Array(H.buffer, H[hdr + 7], cap),
+          s:     new Int32Array(H.buffer,   H[hdr + 8], cap),
+          p:     new Int32Array(H.buffer,   H[hdr + 12], cap),
+          x:     new Float64Array(H.buffer, H[hdr + 9], cap),
+          y:     new Float64Array(H.buffer, H[hdr + 10], cap),
+          ang:   new Float64Array(H.buffer, H[hdr + 11], cap)
+        };
+        layout = H[hdr + 4];
       }
-      console.log('[app] apply arrays -> rxs:', rxs, 'rys:', rys, 'ws:', ws, 'ss:', ss);
+      function get() {
+        const H = Module.HEAPU32;
+        if (!views || layout !== H[hdr + 4] || views.rx.buffer !== H.buffer) map();
+        return views;
+      }
+      return {
+        reserve(n) { return Module._bridge_reserve(n) ? get() : null; },
+        views: get,
+        count() { return Module.HEAP32[hdr + 1]; },
+        setCount(n) { Module.HEAP32[hdr + 1] = n; },
+        touch() { Module.HEAPU32[hdr + 2]++; },          // param_version
+        stateVersion() { return Module.HEAPU32[hdr + 3]; },
+        commit(resetPhases) { return Module._bridge_commit(resetPhases ? 1 : 0); }
+      };
+    }
+
+    const bridge = createBridge(Module);
+    window.__orbital_bridge = bridge; // overlays read positions via views().x/y each frame
+
+    function readRow(row) {
+      return {
+        rx: parseFloat(row.querySelector('.rx').value) || 0.2,
+        ry: parseFloat(row.querySelector('.ry').value) || 0.2,
+        w:  parseFloat(row.querySelector('.w').value)  || 1.0,
+        s:  parseInt(row.querySelector('.s').value,10) || 16,
+        p:  parseInt(row.querySelector('.p').value,10) || 0
+      };
+    }
+
+    // builds without the bridge (older index.wasm): copy the rows through
+    // malloc'd scratch arrays into apply_inputs_from_js; moons are ignored there
+    function applyLegacy(rows) {
+      const n = rows.length;
+      if (typeof Module._malloc !== 'function') { console.error('[app] _malloc not available yet'); return; }
+      const ptr_rx = Module._malloc(n * 8), ptr_ry = Module._malloc(n * 8);
+      const ptr_w  = Module._malloc(n * 8), ptr_s  = Module._malloc(n * 4);
       try {
-        if (typeof Module._malloc !== 'function') { console.error('[app] _malloc not available yet'); return; }
-        const bytesF64 = n * 8;
-        const ptr_rx = Module._malloc(bytesF64);
-        const ptr_ry = Module._malloc(bytesF64);
-        const ptr_w  = Module._malloc(bytesF64);
-        const ptr_s  = Module._malloc(n * 4);
-        Module.HEAPF64.set(rxs, ptr_rx >> 3);
-        Module.HEAPF64.set(rys, ptr_ry >> 3);
-        Module.HEAPF64.set(ws,  ptr_w  >> 3);
-        Module.HEAP32.set(ss,   ptr_s  >> 2);
+        for (let i=0;i<n;i++) {
+          const r = readRow(rows[i]);
+          Module.HEAPF64[(ptr_rx >> 3) + i] = r.rx;
+          Module.HEAPF64[(ptr_ry >> 3) + i] = r.ry;
+          Module.HEAPF64[(ptr_w  >> 3) + i] = r.w;
+          Module.HEAP32[(ptr_s >> 2) + i] = r.s;
+        }
         let ret;
         if (typeof Module._apply_inputs_from_js === 'function') {
           ret = Module._apply_inputs_from_js(n, ptr_rx, ptr_ry, ptr_w, ptr_s);
@@ -219,8 +263,40 @@ document.addEventListener('DOMContentLoaded', function() {
         } else throw new Error('no apply function available');
         console.log('apply_inputs_from_js ->', ret);
       } catch (e) { console.error('apply failed', e); } finally {
-        try { if (typeof Module._free === 'function') { Module._free(ptr_rx); Module._free(ptr_ry); Module._free(ptr_w); Module._free(ptr_s); } } catch(e){}
+        if (typeof Module._free === 'function') { Module._free(ptr_rx); Module._free(ptr_ry); Module._free(ptr_w); Module._free(ptr_s); }
       }
+    }
+
+    // apply / start / stop handlers
+    applyBtn.addEventListener('click', function(){
+      const rows = rowsContainer.querySelectorAll('.row');
+      const n = rows.length;
+      if (n === 0) { console.warn('no rows to apply'); return; }
+      if (!bridge) { applyLegacy(rows); return; }
+      try {
+        const v = bridge.reserve(n);
+        if (!v) throw new Error('bridge_reserve failed');
+        for (let i=0;i<n;i++) {
+          const r = readRow(rows[i]);
+          v.rx[i] = r.rx; v.ry[i] = r.ry; v.w[i] = r.w; v.s[i] = r.s; v.p[i] = r.p;
+        }
+        bridge.setCount(n);
+        bridge.touch();
+        console.log('bridge_commit ->', bridge.commit(true));
+      } catch (e) { console.error('apply failed', e); }
+    });
+
+    // live edits: write the changed field straight into the shared arrays
+    rowsContainer.addEventListener('input', function(ev){
+      if (!bridge) return;
+      const row = ev.target.closest('.row');
+      if (!row) return;
+      const idx = Array.prototype.indexOf.call(rowsContainer.children, row);
+      if (idx < 0 || idx >= bridge.count()) return;
+      const v = bridge.views();
+      const r = readRow(row);
+      v.rx[idx] = r.rx; v.ry[idx] = r.ry; v.w[idx] = r.w; v.s[idx] = r.s; v.p[idx] = r.p;
+      bridge.touch();
     });
 
     startBtn.addEventListener('click', function(){
@@ -230,10 +306,44 @@ document.addEventListener('DOMContentLoaded', function() {
       } catch (e) { console.error('start failed', e); }
     });
 
+    // hidden tab: no rendering, one coarse tick per second (wasm_orbital.c)
+    function syncVisibility() {
+      try {
+        if (typeof Module._set_page_visible === 'function') Module._set_page_visible(document.hidden ? 0 : 1);
+      } catch (e) { console.error('set_page_visible failed', e); }
+    }
+    document.addEventListener('visibilitychange', syncVisibility);
+    syncVisibility();
+
+    if (trailsChk) trailsChk.addEventListener('change', function(){
+      try {
+        if (typeof Module._set_trails === 'function') Module._set_trails(trailsChk.checked ? 1 : 0, 0);
+      } catch (e) { console.error('set_trails failed', e); }
+    });
+
+    // Chrome trace of the last frames (chrome://tracing, ui.perfetto.dev);
+    // only builds made with TRACE=1 record anything
+    function downloadTrace(quiet) {
+      if (typeof Module._trace_dump !== 'function') return;
+      const p = Module._trace_dump();
+      if (!p) { if (!quiet) console.warn('[app] tracing not compiled in (TRACE=1 ./build_wasm.sh)'); return; }
+      const blob = new Blob([Module.UTF8ToString(p)], { type: 'application/json' });
+      const a = document.createElement('a');
+      a.href = URL.createObjectURL(blob);
+      a.download = 'orbitando_trace.json';
+      a.click();
+      setTimeout(function(){ URL.revokeObjectURL(a.href); }, 1000);
+    }
+    if (traceBtn) traceBtn.addEventListener('click', function(){ downloadTrace(false); });
+    document.addEventListener('keydown', function(ev){
+      if (ev.key === 'F9') { ev.preventDefault(); downloadTrace(false); }
+    });
+
     stopBtn.addEventListener('click', function(){
       try {
         if (typeof Module._stop_animation === 'function') Module._stop_animation();
         else if (typeof Module.ccall === 'function') Module.ccall('stop_animation','void',[],[]);
+        downloadTrace(true);
       } catch (e) { console.error('stop failed', e); }
     });
   });
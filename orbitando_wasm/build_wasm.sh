@@ -3,15 +3,20 @@ set -euo pipefail
 
 # Ajuste conforme seu projeto
 SRC="wasm_orbital.c"
+CORE_DIR="../orbitando_core"
+CORE_SRC=("${CORE_DIR}/orbital_core.c" "${CORE_DIR}/orbital_render.c" "${CORE_DIR}/orbital_trace.c")
 OUT_JS="index.js"
 OUT_HTML=""        # deixamos vazio, não gerar HTML automático
 ASSETS_DIR="assets/fonts"
 FONT_FILE="${ASSETS_DIR}/LiberationSans-Regular.ttf"
+# TRACE=1 ./build_wasm.sh grava a linha do tempo dos frames (orbital_trace.h; botão Trace / F9)
+TRACE_FLAGS=""
+if [ "${TRACE:-0}" = "1" ]; then TRACE_FLAGS="-DORBITAL_TRACE"; fi
 
 # Funções C exportadas (apenas as que seu JS chama)
-EXPORTED_FUNCTIONS='["_apply_inputs_from_js","_start_animation","_stop_animation","_set_canvas_size","_malloc","_free"]'
+EXPORTED_FUNCTIONS='["_get_bridge","_bridge_reserve","_bridge_commit","_apply_inputs_from_js","_start_animation","_stop_animation","_set_canvas_size","_set_trails","_set_page_visible","_trace_dump","_malloc","_free"]'
 # Métodos do runtime JS que usamos
-EXPORTED_RUNTIME_METHODS='["ccall","cwrap","getValue","setValue","UTF8ToString","HEAPF64","HEAP32","HEAPU8","FS_createDataFile"]'
+EXPORTED_RUNTIME_METHODS='["ccall","cwrap","getValue","setValue","UTF8ToString","HEAPF64","HEAP32","HEAPU32","HEAPU8","FS_createDataFile"]'
 
 # Verificações básicas
 if ! command -v emcc >/dev/null 2>&1; then
@@ -34,7 +39,7 @@ if [ ! -f "${FONT_FILE}" ]; then
 fi
 
 echo "Compilando ${SRC} -> ${OUT_JS} (com preload ${ASSETS_DIR}) ..."
-emcc "${SRC}" -O2 \
+emcc "${SRC}" "${CORE_SRC[@]}" -I"${CORE_DIR}" -O2 ${TRACE_FLAGS} \
   -s USE_SDL=2 -s USE_SDL_TTF=2 \
   -s ALLOW_MEMORY_GROWTH=1 \
   --preload-file "${ASSETS_DIR}@/assets/fonts" \
@@ -0,0 +1,54 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# Build headless do núcleo da simulação (sem SDL/canvas) para rodar no Node.
+# Gera três variantes para comparar o throughput do lado WASM:
+#   wasm_bench_scalar.js   -O3
+#   wasm_bench_simd.js     -O3 -msimd128
+#   wasm_bench_threads.js  -O3 -msimd128 -pthread (Worker threads do Node)
+# Uso:
+#   ./build_wasm_bench.sh            # só compila
+#   ./build_wasm_bench.sh --run [n] [frames] [threads]   # compila e roda as três
+#   ./build_wasm_bench.sh --check    # compila e valida a precisão do layout float32 (24 h simuladas)
+
+SRC="wasm_bench.c"
+CORE_DIR="../orbitando_core"
+CORE_SRC="${CORE_DIR}/orbital_core.c"
+COMMON=(-O3 -I"${CORE_DIR}" -s ENVIRONMENT=node -s EXPORTED_FUNCTIONS='["_main","_run_benchmark"]')
+
+if ! command -v emcc >/dev/null 2>&1; then
+  echo "Erro: emcc não encontrado no PATH. Ative o emsdk (source /path/to/emsdk_env.sh) e tente novamente."
+  exit 1
+fi
+
+echo "Compilando variantes do benchmark ..."
+emcc "${SRC}" "${CORE_SRC}" "${COMMON[@]}" -s ALLOW_MEMORY_GROWTH=1 \
+  -DBENCH_VARIANT='"scalar"' -o wasm_bench_scalar.js
+emcc "${SRC}" "${CORE_SRC}" "${COMMON[@]}" -s ALLOW_MEMORY_GROWTH=1 -msimd128 \
+  -DBENCH_VARIANT='"simd"' -o wasm_bench_simd.js
+# pthreads + memory growth é lento no WASM: reserva memória fixa (cobre ~1M corpos)
+emcc "${SRC}" "${CORE_SRC}" "${COMMON[@]}" -msimd128 -pthread -DBENCH_THREADS \
+  -s INITIAL_MEMORY=536870912 -s PTHREAD_POOL_SIZE=8 \
+  -DBENCH_VARIANT='"threads"' -o wasm_bench_threads.js
+echo "Compilação finalizada."
+
+if [ "${1:-}" = "--run" ] || [ "${1:-}" = "--check" ]; then
+  if ! command -v node >/dev/null 2>&1; then
+    echo "Erro: node não encontrado no PATH."
+    exit 1
+  fi
+fi
+
+if [ "${1:-}" = "--run" ]; then
+  N="${2:-100000}"; FRAMES="${3:-600}"; THREADS="${4:-4}"
+  for LAYOUT in double compact; do
+    node wasm_bench_scalar.js "${N}" "${FRAMES}" 1 "${LAYOUT}"
+    node wasm_bench_simd.js "${N}" "${FRAMES}" 1 "${LAYOUT}"
+    node wasm_bench_threads.js "${N}" "${FRAMES}" "${THREADS}" "${LAYOUT}"
+  done
+fi
+
+if [ "${1:-}" = "--check" ]; then
+  node wasm_bench_scalar.js --check-precision
+  node wasm_bench_simd.js --check-precision
+fi
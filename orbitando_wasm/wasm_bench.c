@@ -0,0 +1,216 @@
+/*
+ wasm_bench.c
+ Headless benchmark entry: runs only the simulation core (orbital_core.c) and
+ the draw-list construction, with no SDL, canvas or browser. Built by
+ build_wasm_bench.sh as a Node program; also compiles natively with gcc.
+ Exports:
+   - run_benchmark(int n, int frames, int threads, int compact) -- returns ns per body-frame
+ Usage:
+   node wasm_bench.js [n] [frames] [threads] [double|compact]
+   node wasm_bench.js --check-precision [n]
+ Natively, OC_ISA=baseline|avx2|avx512 forces the kernel copy (see orbital_simd.h).
+ Prints one JSON object per run on stdout. --check-precision runs the compact
+ float32 layout against the double path over 24 h of simulated time and exits
+ non-zero if any position differs by more than PRECISION_BOUND_PX.
+*/
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L   /* clock_gettime under -std=c17 */
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "orbital_core.h"
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#else
+#define EMSCRIPTEN_KEEPALIVE
+#endif
+
+#ifdef BENCH_THREADS
+#include <pthread.h>
+#define BENCH_MAXTHREADS 8   /* = PTHREAD_POOL_SIZE in build_wasm_bench.sh */
+#endif
+
+#ifndef BENCH_VARIANT
+#define BENCH_VARIANT "scalar"
+#endif
+
+#define BENCH_W 1024
+#define BENCH_H 768
+#define BENCH_DT 0.016
+
+#define PRECISION_HOURS 24
+#define PRECISION_BOUND_PX 0.05
+
+static OcBodies g_sys;
+static OcCompact g_cmp;
+static int g_compact = 0;
+static long g_frame_no = 0;     /* frames simulated so far; time = g_frame_no * BENCH_DT */
+static double *g_x, *g_y;
+static float *g_fx, *g_fy;
+static OcDrawItem *g_draw;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* same spread the UI defaults produce, extended to any n */
+static int setup(int n) {
+    if (!oc_reserve(&g_sys, n)) return 0;
+    free(g_x); free(g_y); free(g_fx); free(g_fy); free(g_draw);
+    g_x = malloc(sizeof(double) * n);
+    g_y = malloc(sizeof(double) * n);
+    g_fx = malloc(sizeof(float) * n);
+    g_fy = malloc(sizeof(float) * n);
+    g_draw = malloc(sizeof(OcDrawItem) * n);
+    if (!g_x || !g_y || !g_fx || !g_fy || !g_draw) return 0;
+    double base = oc_base_radius(BENCH_W, BENCH_H);
+    g_sys.n = n;
+    for (int i = 0; i < n; ++i) {
+        double f = (double)i / (double)n;
+        g_sys.rx[i] = (0.10 + 1.30 * f) * base;
+        g_sys.ry[i] = (0.08 + 1.10 * f) * base;
+        g_sys.omega[i] = (0.6 + 0.9 * ((i * 7919) % 1000) / 1000.0) * 0.5;
+        g_sys.size[i] = 8 + (i % 5) * 4;
+        g_sys.color[i] = (OcColor){255,255,255,255};
+        g_sys.parent[i] = -1;   /* flat: no moons, so no propagation pass to time */
+    }
+    oc_hierarchy_update(&g_sys);
+    oc_init_phases(&g_sys);
+    g_frame_no = 0;
+    return oc_compact_from_bodies(&g_cmp, &g_sys, 0.0);
+}
+
+/* one frame for [first, last) at time t; *t0 is the epoch this range was rebased to */
+static void frame_range(int first, int last, double t, double *t0) {
+    if (g_compact) {
+        double e = oc_epoch_start(t);
+        if (e != *t0) { oc_compact_rebase(&g_cmp, first, last, e); *t0 = e; }
+        float tau = (float)(t - e);
+        oc_compact_positions(&g_cmp, first, last, tau, BENCH_W/2, BENCH_H/2, g_fx, g_fy);
+        oc_compact_draw_list(&g_cmp, first, last, tau, g_fx, g_fy, g_draw);
+    } else {
+        oc_advance(&g_sys, first, last, BENCH_DT);
+        oc_positions(&g_sys, first, last, BENCH_W/2, BENCH_H/2, g_x, g_y);
+        oc_build_draw_list(&g_sys, first, last, g_x, g_y, g_draw);
+    }
+}
+
+#ifdef BENCH_THREADS
+typedef struct { int first, last, frames; long start; double t0; pthread_barrier_t *bar; } Slice;
+
+static void* slice_main(void *arg) {
+    Slice *s = (Slice*)arg;
+    for (int f = 0; f < s->frames; ++f) {
+        frame_range(s->first, s->last, (s->start + f + 1) * BENCH_DT, &s->t0);
+        pthread_barrier_wait(s->bar);   /* frame boundary, as a renderer would need */
+    }
+    return NULL;
+}
+
+static void run_frames(int n, int frames, int threads) {
+    if (threads < 2) {
+        for (int f = 0; f < frames; ++f) frame_range(0, n, ++g_frame_no * BENCH_DT, &g_cmp.t0);
+        return;
+    }
+    pthread_t tid[BENCH_MAXTHREADS];
+    Slice sl[BENCH_MAXTHREADS];
+    pthread_barrier_t bar;
+    pthread_barrier_init(&bar, NULL, (unsigned)threads);
+    for (int t = 0; t < threads; ++t) {
+        sl[t].first = (int)((long long)n * t / threads);
+        sl[t].last = (int)((long long)n * (t + 1) / threads);
+        sl[t].frames = frames;
+        sl[t].start = g_frame_no;
+        sl[t].t0 = g_cmp.t0;
+        sl[t].bar = &bar;
+        if (t > 0) pthread_create(&tid[t], NULL, slice_main, &sl[t]);
+    }
+    slice_main(&sl[0]);
+    for (int t = 1; t < threads; ++t) pthread_join(tid[t], NULL);
+    pthread_barrier_destroy(&bar);
+    g_frame_no += frames;
+    g_cmp.t0 = sl[0].t0;
+}
+#else
+static void run_frames(int n, int frames, int threads) {
+    (void)threads;
+    for (int f = 0; f < frames; ++f) frame_range(0, n, ++g_frame_no * BENCH_DT, &g_cmp.t0);
+}
+#endif
+
+EMSCRIPTEN_KEEPALIVE
+double run_benchmark(int n, int frames, int threads, int compact) {
+    if (n < 1 || frames < 1) return -1.0;
+    g_compact = compact != 0;
+    if (!setup(n)) { fprintf(stderr, "out of memory for n=%d\n", n); return -1.0; }
+    run_frames(n, frames / 10 + 1, threads);   /* warmup */
+    double t0 = now_sec();
+    run_frames(n, frames, threads);
+    double el = now_sec() - t0;
+    return el * 1e9 / ((double)n * (double)frames);
+}
+
+/* compact layout vs double path at 60 Hz, compared once per simulated minute */
+static int check_precision(int n) {
+    if (n < 2 || !setup(n)) return 0;
+    double base = oc_base_radius(BENCH_W, BENCH_H);
+    for (int i = 0; i < n; ++i) {
+        double f = (double)i / (double)(n - 1);
+        g_sys.rx[i] = (0.01 + 1.49 * f) * base;      /* full UI range 0.01..1.5 */
+        g_sys.ry[i] = (1.50 - 1.49 * f) * base;
+        g_sys.omega[i] = (-10.0 + 20.0 * f) * 0.5;   /* full UI range -10..10 */
+    }
+    if (!oc_compact_from_bodies(&g_cmp, &g_sys, 0.0)) return 0;
+    const double dt = 1.0 / 60.0;
+    const long steps = PRECISION_HOURS * 3600L * 60L;
+    double max_err = 0.0;
+    for (long k = 1; k <= steps; ++k) {
+        oc_advance(&g_sys, 0, n, dt);
+        if (k % 3600 != 0) continue;
+        double t = k * dt;
+        oc_positions(&g_sys, 0, n, BENCH_W/2, BENCH_H/2, g_x, g_y);
+        oc_compact_set_time(&g_cmp, t);
+        oc_compact_positions(&g_cmp, 0, n, (float)(t - g_cmp.t0), BENCH_W/2, BENCH_H/2, g_fx, g_fy);
+        for (int i = 0; i < n; ++i) {
+            double ex = fabs(g_x[i] - g_fx[i]), ey = fabs(g_y[i] - g_fy[i]);
+            if (ex > max_err) max_err = ex;
+            if (ey > max_err) max_err = ey;
+        }
+    }
+    int pass = max_err <= PRECISION_BOUND_PX;
+    printf("{\"check\":\"precision\",\"variant\":\"%s\",\"n\":%d,\"hours\":%d,"
+           "\"max_err_px\":%.6f,\"bound_px\":%.3f,\"pass\":%s}\n",
+           BENCH_VARIANT, n, PRECISION_HOURS, max_err, PRECISION_BOUND_PX, pass ? "true" : "false");
+    return pass;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "--check-precision") == 0)
+        return check_precision(argc > 2 ? atoi(argv[2]) : 128) ? 0 : 1;
+
+    int n = argc > 1 ? atoi(argv[1]) : 100000;
+    int frames = argc > 2 ? atoi(argv[2]) : 600;
+    int threads = argc > 3 ? atoi(argv[3]) : 1;
+    int compact = argc > 4 && strcmp(argv[4], "compact") == 0;
+#ifdef BENCH_THREADS
+    if (threads < 1) threads = 1;
+    if (threads > BENCH_MAXTHREADS) threads = BENCH_MAXTHREADS;
+#else
+    threads = 1;
+#endif
+    double ns = run_benchmark(n, frames, threads, compact);
+    if (ns < 0) return 1;
+    /* checksum keeps the work observable */
+    double sum = 0;
+    for (int i = 0; i < n; ++i) sum += g_draw[i].x + g_draw[i].y;
+    printf("{\"variant\":\"%s\",\"isa\":\"%s\",\"layout\":\"%s\",\"n\":%d,\"frames\":%d,\"threads\":%d,"
+           "\"ns_per_body_frame\":%.3f,\"bodies_per_sec\":%.0f,\"checksum\":%.0f}\n",
+           BENCH_VARIANT, oc_isa_name(oc_isa()), compact ? "compact" : "double", n, frames, threads, ns, 1e9 / ns, sum);
+    return 0;
+}
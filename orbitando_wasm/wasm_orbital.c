@@ -2,11 +2,23 @@
  wasm_orbital.c
  WebAssembly entry: receives inputs from JS and runs the animation using SDL2.
  Exports:
-   - apply_inputs_from_js(int N, double* rx, double* ry, double* omega, int* size)
+   - get_bridge()        -- persistent parameter/state arrays shared with JS (see Bridge)
+   - bridge_reserve(int n) -- grow the shared arrays to hold n bodies
+   - bridge_commit(int reset_phases) -- apply the shared parameters now
+   - apply_inputs_from_js(int N, double* rx, double* ry, double* omega, int* size)  (no moons)
    - start_animation()  -- begins main loop (uses emscripten_set_main_loop)
    - stop_animation()
    - set_canvas_size(int w, int h)
+   - set_trails(int enabled, int fade) -- motion trails (fade 1..255, higher = shorter)
+   - set_page_visible(int visible) -- from the page's visibilitychange: hidden, the
+                           loop drops to one coarse tick per HIDDEN_TICK_MS with no
+                           rendering; shown again, it jumps to the exact time
+   - trace_dump()       -- Chrome trace JSON of the recorded frames (build with TRACE=1,
+                           see orbital_trace.h); NULL when tracing is compiled out
 */
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L   /* open_memstream under -std=c17 */
+#endif
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include <emscripten.h>
@@ -14,6 +26,9 @@
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
+#include "orbital_core.h"
+#include "orbital_render.h"
+#include "orbital_trace.h"
 
 #ifndef WIN_W
 #define WIN_W 1024
@@ -22,27 +37,41 @@
 #define WIN_H 768
 #endif
 
-#define ORBITAL_MAXOBJ 15
+/* hard cap for the shared arrays; the HTML form itself still builds at most 15 rows */
+#define ORBITAL_MAXOBJ (1 << 20)
 #ifndef PALETTE_COUNT
 #define PALETTE_COUNT 10
 #endif
 
-typedef struct {
-    double rx, ry;
-    double ang;
-    double omega;
-    int size;
-    SDL_Color color;
-} Body;
-
-static const SDL_Color palette[] = {
+static const OcColor palette[] = {
     {255,80,80,255},{80,255,120,255},{100,160,255,255},{180,100,255,255},
     {255,200,80,255},{160,160,160,255},{0,200,200,255},{255,120,200,255},
     {200,200,100,255},{160,80,200,255}
 };
 
-static Body bodies[ORBITAL_MAXOBJ];
-static int global_N = 0;
+static OcBodies g_sys;
+static OcFrame g_frame;
+
+/* Shared-memory bridge.
+   JS maps these arrays once as typed-array views (app.js) instead of copying
+   through _malloc on every Apply. The parameter arrays hold the values as typed
+   in the UI; JS edits them in place and bumps param_version, and step() picks
+   the change up at the next frame. The state arrays are written by step().
+   All fields are 32-bit in wasm32, so JS reads the header with HEAPU32. */
+typedef struct {
+    int capacity;             /* entries allocated in each array */
+    int count;                /* bodies in use (written by JS) */
+    unsigned param_version;   /* bumped by JS after editing the parameters */
+    unsigned state_version;   /* bumped by wasm after each simulated frame */
+    unsigned layout_version;  /* bumped by wasm when the arrays move (remap views) */
+    double *rx, *ry, *omega;  /* relative semi-axes and w, as in the UI */
+    int *size;
+    double *x, *y, *ang;      /* canvas position (pixels) and angle (radians); alias g_frame/g_sys */
+    int *parent;              /* parameter: 0 = sun, k = orbits object k (must be < own number) */
+} Bridge;
+
+static Bridge g_bridge;
+static unsigned applied_version = 0;
 
 /* SDL objects */
 static SDL_Window *g_win = NULL;
@@ -50,51 +79,119 @@ static SDL_Renderer *g_rnd = NULL;
 static int canvas_w = WIN_W;
 static int canvas_h = WIN_H;
 static int running_main = 0;
-static SDL_Texture *texs[ORBITAL_MAXOBJ];
+static OrSprites g_sprites;
+static OrBackground g_bg = { .segments = 120 };
+static OrTrails g_trails = { .fade = 12 };
+static int trails_on = 0;
 
 static TTF_Font *g_font = NULL;
 
-static SDL_Texture* make_square_texture(SDL_Renderer *rnd, int size, SDL_Color col) {
-    SDL_Texture *tex = SDL_CreateTexture(rnd, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, size, size);
-    if (!tex) return NULL;
-    SDL_Texture *old = SDL_GetRenderTarget(rnd);
-    SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
-    SDL_SetRenderTarget(rnd, tex);
-    SDL_SetRenderDrawBlendMode(rnd, SDL_BLENDMODE_NONE);
-    SDL_SetRenderDrawColor(rnd, col.r, col.g, col.b, col.a);
-    SDL_Rect r = {0,0,size,size};
-    SDL_RenderFillRect(rnd, &r);
-    SDL_SetRenderDrawColor(rnd, (Uint8)fmax(0,col.r-30), (Uint8)fmax(0,col.g-30), (Uint8)fmax(0,col.b-30), col.a);
-    SDL_RenderDrawRect(rnd, &r);
-    SDL_SetRenderTarget(rnd, old);
-    return tex;
+/* Page visibility. Hidden, the main loop runs on a timer instead of
+   requestAnimationFrame and step() only advances the state (JS overlays
+   still read it); phases jump by the exact elapsed time (oc_seek). */
+#define HIDDEN_TICK_MS 1000
+static int page_hidden = 0, page_resumed = 0;
+static double last_now = -1.0;   /* emscripten_get_now() of the previous step, ms */
+
+/* push parameter changes to the GPU caches; untouched bodies cost nothing */
+static void sync_gpu(void) {
+    or_sprites_sync(&g_sprites, g_rnd, &g_sys);
+    or_background_sync(&g_bg, g_rnd, &g_sys, canvas_w, canvas_h);
 }
 
-/* helper: create or update textures */
-static void create_textures() {
-    for (int i = 0; i < ORBITAL_MAXOBJ; ++i) {
-        if (texs[i]) { SDL_DestroyTexture(texs[i]); texs[i] = NULL; }
+static int grow_array(void **p, size_t elem, int cap) {
+    void *np = realloc(*p, elem * (size_t)cap);
+    if (!np) return 0;
+    *p = np;
+    return 1;
+}
+
+EMSCRIPTEN_KEEPALIVE
+Bridge* get_bridge() {
+    return &g_bridge;
+}
+
+EMSCRIPTEN_KEEPALIVE
+Bridge* bridge_reserve(int n) {
+    if (n > ORBITAL_MAXOBJ) n = ORBITAL_MAXOBJ;
+    if (n <= g_bridge.capacity) return &g_bridge;
+    int cap = g_bridge.capacity ? g_bridge.capacity : 16;
+    while (cap < n) cap *= 2;
+    if (cap > ORBITAL_MAXOBJ) cap = ORBITAL_MAXOBJ;
+    const void *before[8] = { g_bridge.rx, g_bridge.ry, g_bridge.omega, g_bridge.size, g_bridge.parent,
+                              g_frame.x, g_frame.y, g_sys.ang };
+    int ok = grow_array((void**)&g_bridge.rx, sizeof(double), cap) &&
+             grow_array((void**)&g_bridge.ry, sizeof(double), cap) &&
+             grow_array((void**)&g_bridge.omega, sizeof(double), cap) &&
+             grow_array((void**)&g_bridge.size, sizeof(int), cap) &&
+             grow_array((void**)&g_bridge.parent, sizeof(int), cap) &&
+             oc_reserve(&g_sys, cap) &&
+             oc_frame_reserve(&g_frame, cap);
+    /* a failure part way leaves the arrays that did grow moved (still with
+       the old capacity's contents): JS must remap either way */
+    g_bridge.x = g_frame.x;
+    g_bridge.y = g_frame.y;
+    g_bridge.ang = g_sys.ang;
+    const void *after[8] = { g_bridge.rx, g_bridge.ry, g_bridge.omega, g_bridge.size, g_bridge.parent,
+                             g_frame.x, g_frame.y, g_sys.ang };
+    if (!ok) {
+        if (memcmp(before, after, sizeof(before)) != 0) g_bridge.layout_version++;
+        printf("bridge_reserve(%d): out of memory\n", n);
+        return NULL;
     }
-    for (int i = 0; i < global_N; ++i) {
-        texs[i] = make_square_texture(g_rnd, bodies[i].size, bodies[i].color);
+    for (int i = g_bridge.capacity; i < cap; ++i) g_bridge.parent[i] = 0;
+    g_bridge.capacity = cap;
+    g_bridge.layout_version++;
+    return &g_bridge;
+}
+
+/* rebuild bodies from the shared parameters; phases are kept unless N changed */
+static void bridge_sync(int reset_phases) {
+    int N = g_bridge.count;
+    if (N > g_bridge.capacity) N = g_bridge.capacity;
+    applied_version = g_bridge.param_version;
+    if (N < 1) return;
+    OTR_BEGIN("bridge sync");
+    if (N != g_sys.n) reset_phases = 1;
+    double baseRadius = oc_base_radius(canvas_w, canvas_h);
+    for (int i = 0; i < N; ++i) {
+        g_sys.rx[i] = g_bridge.rx[i] * baseRadius;
+        g_sys.ry[i] = g_bridge.ry[i] * baseRadius;
+        g_sys.omega[i] = g_bridge.omega[i] * 0.5;
+        g_sys.size[i] = g_bridge.size[i];
+        g_sys.color[i] = palette[i % PALETTE_COUNT];
+        int p = g_bridge.parent[i];
+        g_sys.parent[i] = (p >= 1 && p <= i) ? p - 1 : -1;   /* invalid -> sun */
     }
+    g_sys.n = N;
+    oc_hierarchy_update(&g_sys);
+    if (reset_phases) { oc_init_phases(&g_sys); or_trails_reset(&g_trails); }
+    if (g_rnd) sync_gpu();
+    OTR_END();
+}
+
+EMSCRIPTEN_KEEPALIVE
+int bridge_commit(int reset_phases) {
+    if (g_bridge.count < 1) return 0;
+    bridge_sync(reset_phases);
+    return 1;
 }
 
 EMSCRIPTEN_KEEPALIVE
 int apply_inputs_from_js(int N, double *rx, double *ry, double *omega, int *size) {
     if (N < 1) return 0;
     if (N > ORBITAL_MAXOBJ) N = ORBITAL_MAXOBJ;
-    double baseRadius = (canvas_w < canvas_h ? canvas_w : canvas_h) / 2.0 - 30.0;
-    for (int i = 0; i < N; ++i) {
-        bodies[i].rx = rx[i] * baseRadius;
-        bodies[i].ry = ry[i] * baseRadius;
-        bodies[i].omega = omega[i] * 0.5;
-        bodies[i].size = size[i];
-        bodies[i].ang = (double)i * (2.0*M_PI / (double)N);
-        bodies[i].color = palette[i % PALETTE_COUNT];
-    }
-    global_N = N;
-    if (g_rnd) create_textures();
+    OTR_BEGIN("apply_inputs_from_js");
+    if (!bridge_reserve(N)) { OTR_END(); return 0; }
+    memcpy(g_bridge.rx, rx, sizeof(double) * N);
+    memcpy(g_bridge.ry, ry, sizeof(double) * N);
+    memcpy(g_bridge.omega, omega, sizeof(double) * N);
+    memcpy(g_bridge.size, size, sizeof(int) * N);
+    memset(g_bridge.parent, 0, sizeof(int) * N);
+    g_bridge.count = N;
+    g_bridge.param_version++;
+    bridge_sync(1);
+    OTR_END();
     return 1;
 }
 
@@ -107,70 +204,96 @@ void set_canvas_size(int w, int h) {
     }
 }
 
+EMSCRIPTEN_KEEPALIVE
+void set_trails(int enabled, int fade) {
+    trails_on = enabled != 0;
+    if (fade >= 1 && fade <= 255) g_trails.fade = (Uint8)fade;
+    or_trails_reset(&g_trails);
+}
+
 static void step(void *arg) {
     (void)arg;
     if (!running_main) return;
+    OTR_BEGIN("frame");
     SDL_Event ev;
-    while (SDL_PollEvent(&ev)) {
-        if (ev.type == SDL_QUIT) { running_main = 0; }
+    OTR_SCOPE("events") {
+        while (SDL_PollEvent(&ev)) {
+            if (ev.type == SDL_QUIT) { running_main = 0; }
+        }
     }
 
-    /* advance simulation */
-    static double last = 0;
-    static int first = 1;
-    double dt = 0.016;
-    if (!first) dt = 0.016; else first = 0;
+    /* live edits made by JS directly in the shared parameter arrays */
+    if (g_bridge.param_version != applied_version) bridge_sync(0);
 
-    for (int i = 0; i < global_N; ++i) {
-        bodies[i].ang += bodies[i].omega * dt;
-        if (bodies[i].ang > 2.0*M_PI) bodies[i].ang -= 2.0*M_PI;
-        if (bodies[i].ang < 0) bodies[i].ang += 2.0*M_PI;
-    }
-
-    /* render */
-    if (g_rnd == NULL) return;
-    SDL_SetRenderDrawColor(g_rnd, 0,0,0,255);
-    SDL_RenderClear(g_rnd);
+    /* advance simulation by the wall-clock time; a tick while hidden, or the
+       first one back, takes all of it in closed form */
+    double now = emscripten_get_now();
+    double dt = last_now < 0 ? 0.0 : (now - last_now) * 1e-3;
+    int coarse = page_hidden || page_resumed;
+    last_now = now;
+    if (dt > 0.1 && !coarse) dt = 0.1;
 
+    /* publish state for JS overlays (ang is shared directly) */
+    int N = g_sys.n;
     int cx = canvas_w / 2;
     int cy = canvas_h / 2;
+    OTR_SCOPE("simulate") {
+        if (coarse) oc_seek(&g_sys, 0, N, dt);
+        else oc_advance(&g_sys, 0, N, dt);
+        oc_positions(&g_sys, 0, N, cx, cy, g_frame.x, g_frame.y);
+        oc_propagate(&g_sys, cx, cy, g_frame.x, g_frame.y);
+    }
+    g_bridge.state_version++;
 
-    /* orbits */
-    SDL_SetRenderDrawColor(g_rnd, 64,200,220,255);
-    for (int i = 0; i < global_N; ++i) {
-        int a = (int)round(bodies[i].rx);
-        int b = (int)round(bodies[i].ry);
-        const int TABLE_SIZE = 120;
-        int px = cx + a, py = cy;
-        for (int k = 0; k <= TABLE_SIZE; ++k) {
-            double t = (2.0 * M_PI * k) / TABLE_SIZE;
-            int x = cx + (int)round(a * cos(t));
-            int y = cy + (int)round(b * sin(t));
-            SDL_RenderDrawLine(g_rnd, px, py, x, y);
-            px = x; py = y;
-        }
+    /* render: cached orbit background, then the sprites */
+    if (g_rnd == NULL || page_hidden) { OTR_END(); return; }
+    if (page_resumed) {
+        page_resumed = 0;
+        or_trails_reset(&g_trails);   /* the bodies jumped */
+    }
+    if (trails_on) OTR_SCOPE("trails") or_trails_update(&g_trails, g_rnd, &g_sys, g_frame.x, g_frame.y, canvas_w, canvas_h);
+    OTR_SCOPE("background") {
+        if (g_bg.tex) SDL_RenderCopy(g_rnd, g_bg.tex, NULL, NULL);
+        else { SDL_SetRenderDrawColor(g_rnd, 0,0,0,255); SDL_RenderClear(g_rnd); }
+        if (trails_on) or_trails_draw(g_rnd, &g_trails);
     }
 
-    SDL_Rect sun = {cx-8, cy-8, 16, 16};
-    SDL_SetRenderDrawColor(g_rnd, 255,215,0,255);
-    SDL_RenderFillRect(g_rnd, &sun);
-
-    for (int i = 0; i < global_N; ++i) {
-        double x = cx + bodies[i].rx * cos(bodies[i].ang);
-        double y = cy + bodies[i].ry * sin(bodies[i].ang);
-        int s = bodies[i].size;
-        SDL_Rect dst = { (int)round(x - s/2.0), (int)round(y - s/2.0), s, s };
-        if (texs[i]) {
-            double deg = (bodies[i].ang / (2.0*M_PI)) * 360.0 * 2.0;
-            SDL_Point center = { s/2, s/2 };
-            SDL_RenderCopyEx(g_rnd, texs[i], NULL, &dst, deg, &center, SDL_FLIP_NONE);
-        } else {
-            SDL_SetRenderDrawColor(g_rnd, bodies[i].color.r, bodies[i].color.g, bodies[i].color.b, bodies[i].color.a);
-            SDL_RenderFillRect(g_rnd, &dst);
-        }
+    OTR_SCOPE("bodies") {
+        oc_build_draw_list(&g_sys, 0, N, g_frame.x, g_frame.y, g_frame.items);
+        or_draw_bodies(g_rnd, &g_sprites, &g_sys, g_frame.items, N);
     }
 
-    SDL_RenderPresent(g_rnd);
+    OTR_SCOPE("present") SDL_RenderPresent(g_rnd);
+    OTR_END();
+}
+
+EMSCRIPTEN_KEEPALIVE
+void set_page_visible(int visible) {
+    int hidden = !visible;
+    if (hidden == page_hidden) return;
+    page_hidden = hidden;
+    page_resumed |= !hidden;
+    if (!running_main) return;
+    if (hidden) emscripten_set_main_loop_timing(EM_TIMING_SETTIMEOUT, HIDDEN_TICK_MS);
+    else emscripten_set_main_loop_timing(EM_TIMING_RAF, 1);
+}
+
+EMSCRIPTEN_KEEPALIVE
+const char* trace_dump() {
+#ifdef ORBITAL_TRACE
+    /* kept until the next call so JS can read it with UTF8ToString */
+    static char *json = NULL;
+    size_t len = 0;
+    free(json);
+    json = NULL;
+    FILE *f = open_memstream(&json, &len);
+    if (!f) return NULL;
+    int ok = otr_write(f);
+    fclose(f);
+    return ok ? json : NULL;
+#else
+    return NULL;
+#endif
 }
 
 EMSCRIPTEN_KEEPALIVE
@@ -194,10 +317,13 @@ int start_animation() {
         printf("SDL_CreateRenderer failed: %s\n", SDL_GetError());
         return 0;
     }
-    create_textures();
+    sync_gpu();
     running_main = 1;
-    /* use emscripten main loop */
-    emscripten_set_main_loop_arg(step, NULL, 0, 1);
+    last_now = -1.0;
+    /* use emscripten main loop; simulate_infinite_loop = 0 so the timing can
+       be switched right away if the page is already hidden */
+    emscripten_set_main_loop_arg(step, NULL, 0, 0);
+    if (page_hidden) emscripten_set_main_loop_timing(EM_TIMING_SETTIMEOUT, HIDDEN_TICK_MS);
     return 1;
 }
 
@@ -206,9 +332,9 @@ void stop_animation() {
     if (!running_main) return;
     running_main = 0;
     emscripten_cancel_main_loop();
-    for (int i = 0; i < ORBITAL_MAXOBJ; ++i) {
-        if (texs[i]) { SDL_DestroyTexture(texs[i]); texs[i] = NULL; }
-    }
+    or_sprites_free(&g_sprites);
+    or_background_free(&g_bg);
+    or_trails_free(&g_trails);
     if (g_rnd) { SDL_DestroyRenderer(g_rnd); g_rnd = NULL; }
     if (g_win) { SDL_DestroyWindow(g_win); g_win = NULL; }
     TTF_Quit();